@@ -0,0 +1,74 @@
+#include "llvm/System/DataTypes.h"
+#include "llvm/System/TimeValue.h"
+
+using namespace llvm;
+
+#ifndef ANALYSISBUDGET_H
+#define ANALYSISBUDGET_H
+
+//limits the work spent on a loop or a function, counted in work units (parameter
+//visits and definitions walked) and/or in wall time. A limit of 0 means unlimited
+class AnalysisBudget
+{
+    public:
+
+        //reading the clock costs much more than a parameter visit, so wall time is
+        //only looked at once every that many units
+        static const uint64_t TimeCheckInterval = 1024;
+
+        AnalysisBudget() : m_maxUnits(0), m_maxMilliseconds(0), m_units(0), m_exceeded(false) {}
+
+        void start(uint64_t maxUnits, uint64_t maxMilliseconds)
+        {
+            m_maxUnits = maxUnits;
+            m_maxMilliseconds = maxMilliseconds;
+            m_units = 0;
+            m_exceeded = false;
+
+            if (m_maxMilliseconds != 0)
+            {
+                m_start = sys::TimeValue::now();
+            }
+        }
+
+        //return false once the budget is used up
+        bool charge(uint64_t units)
+        {
+            uint64_t previous = m_units;
+            m_units += units;
+
+            if (m_maxUnits != 0 && m_units > m_maxUnits)
+            {
+                m_exceeded = true;
+            }
+            else if (previous / TimeCheckInterval != m_units / TimeCheckInterval)
+            {
+                checkTime();
+            }
+
+            return !m_exceeded;
+        }
+
+        //look at the clock now, after a step that is not charged unit by unit
+        bool checkTime(void)
+        {
+            if (m_maxMilliseconds != 0 && (sys::TimeValue::now() - m_start).msec() > m_maxMilliseconds)
+            {
+                m_exceeded = true;
+            }
+
+            return !m_exceeded;
+        }
+
+        bool isExceeded(void) const { return m_exceeded; }
+        uint64_t getUnits(void) const { return m_units; }
+
+    private:
+        uint64_t m_maxUnits;
+        uint64_t m_maxMilliseconds;
+        uint64_t m_units;
+        bool m_exceeded;
+        sys::TimeValue m_start;
+};
+
+#endif //ANALYSISBUDGET_H
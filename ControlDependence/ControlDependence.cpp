@@ -12,9 +12,10 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/Analysis/PostDominators.h"
 #include "ControlDependence.h"
+#include "../utils.h"
 #include <iostream>
 
 using namespace llvm;
@@ -32,20 +33,11 @@ C("control-dependence", "Compute control dependences");
 bool ControlDependence::isControlDependent(BasicBlock* B, BasicBlock* A) const {
     assert(A != NULL && B != NULL && "Inputs cannot be NULL");
 
-    // find all the blocks that are control dependent on A
-    ControlDependentTy::const_iterator where = ControlDependents.find(A);
-    if (where != ControlDependents.end())
-    {
-        // check to see if B is one of those blocks
-        std::vector<BasicBlock*>::const_iterator where2 = 
-            std::find(where->second.begin(), where->second.end(), B);
-        if (where2 != where->second.end())
-        {
-            return true;
-        }
-    }
+    // find all the blocks that are control dependent on A and check to see
+    // if B is one of those blocks
+    const std::vector<BasicBlock*>& dependents = ControlDependents[Numbering->getBlockNumber(A)];
 
-    return false;
+    return std::find(dependents.begin(), dependents.end(), B) != dependents.end();
 }
 
 // Return true if B is control dependent on A. For this to work,
@@ -83,18 +75,77 @@ ControlDependence::getControlDependenceInstructions(Instruction* A) {
 }
 
 
-// Compute control dependences for all basic blocks of this function
+ControlDependence::~ControlDependence() {
+    delete PDT;
+}
+
+// Remember the function, the dependences are computed on demand
 //
 bool ControlDependence::runOnFunction(Function& F) {
+    setFunction(F, getAnalysis<ValueNumbering>());
+    return false;
+}
+
+void ControlDependence::setFunction(Function& F, const ValueNumbering& N) {
+    Numbering = &N;
+    CurrentFunction = &F;
+    Computed = false;
+}
+
+// Compute control dependences for all basic blocks of the current function
+//
+void ControlDependence::compute() {
+    assert(CurrentFunction != NULL && "compute called before runOnFunction");
+    if (Computed)
+    {
+        return;
+    }
+
+    if (PDT == NULL)
+    {
+        PDT = new PostDominatorTree();
+    }
+
+    PDT->runOnFunction(*CurrentFunction);
+    computeDependences(*CurrentFunction);
+    Computed = true;
+}
+
+// Rebuild the post-dominator tree and the dependences of F and report the blocks
+// whose dependences are not the same as before
+//
+void ControlDependence::update(Function& F, BitVector& AffectedBlocks) {
+    assert(Computed && "update called before compute");
+
+    ControlDependenceTy OldDependences;
+    OldDependences.swap(ControlDependences);
+
+    PDT->runOnFunction(F);
+    computeDependences(F);
+
+    // new blocks are changed blocks, the caller already knows about them
+    for (unsigned I = 0, E = OldDependences.size(); I != E; ++I)
+    {
+        unsigned N = Numbering->getNewBlockNumber(I);
+        if (N != ValueNumbering::Unnumbered && OldDependences[I] != ControlDependences[N])
+        {
+            AffectedBlocks.set(N);
+        }
+    }
+}
+
+void ControlDependence::computeDependences(Function& F) {
+    unsigned NumBlocks = Numbering->getNumBlocks();
+
     ControlDependents.clear();
     ControlDependences.clear();
-
-    PostDominatorTree& PDT = getAnalysis<PostDominatorTree>(); 
+    ControlDependents.resize(NumBlocks);
+    ControlDependences.resize(NumBlocks);
 
     typedef std::pair<BasicBlock*, BasicBlock*> CFGEdge;
     std::list<CFGEdge> notDominated;
 
-    DenseMap<BasicBlock*, bool> Visited;
+    BitVector Visited(NumBlocks);
     std::queue<BasicBlock*> BQ;
 
     // do a BFS and find all CFG edges (C, B) such that B does not post-dominate C
@@ -110,16 +161,17 @@ bool ControlDependence::runOnFunction(Function& F) {
         {
             BasicBlock* B = *I;
 
-            if (!PDT.dominates(B, C))
+            if (!PDT->dominates(B, C))
             {
                 notDominated.push_back(CFGEdge(C, B));
                 assert(getBranchInstruction(C) != NULL && "bug in PDT!");
             }
 
-            if (Visited.count(B) == false)
+            unsigned BNumber = Numbering->getBlockNumber(B);
+            if (!Visited.test(BNumber))
             {
-                //mark block C as visited
-                Visited.insert(std::pair<BasicBlock*, bool>(B, true));
+                //mark block B as visited
+                Visited.set(BNumber);
                 BQ.push(B);
             }
         }
@@ -135,24 +187,23 @@ bool ControlDependence::runOnFunction(Function& F) {
             E = notDominated.end(); I != E; ++I)
     {
         BasicBlock* CbasicBlock = I->first;
-        DomTreeNode* CdomTreeNode = PDT[CbasicBlock];
+        DomTreeNode* CdomTreeNode = (*PDT)[CbasicBlock];
+        std::vector<BasicBlock*>& Cdependents = ControlDependents[Numbering->getBlockNumber(CbasicBlock)];
 
-        DomTreeNode* BdomTreeNode = PDT[I->second];
+        DomTreeNode* BdomTreeNode = (*PDT)[I->second];
         DomTreeNode* NdomTreeNode = BdomTreeNode;
         BasicBlock* NbasicBlock = NdomTreeNode->getBlock();
 
         do
         {
-            ControlDependents[CbasicBlock].push_back(NbasicBlock);
+            Cdependents.push_back(NbasicBlock);
 
-            ControlDependences[NbasicBlock].push_back(CbasicBlock);
+            ControlDependences[Numbering->getBlockNumber(NbasicBlock)].push_back(CbasicBlock);
 
             NdomTreeNode = NdomTreeNode->getIDom();
 
         } while (NdomTreeNode != NULL && NdomTreeNode != CdomTreeNode->getIDom());
     }
-
-    return false;
 }
 
 Instruction* ControlDependence::getBranchInstruction(BasicBlock* B) const {
@@ -161,7 +212,7 @@ Instruction* ControlDependence::getBranchInstruction(BasicBlock* B) const {
 /*
     if (ControlDependents.find(B) == ControlDependents.end())
     {
-        std::cout << B->getName().str() << " has not control dependents\n";
+        ielErr() << B->getName().str() << " has not control dependents\n";
         return NULL;
     }
 */
@@ -186,8 +237,8 @@ Instruction* ControlDependence::getBranchInstruction(BasicBlock* B) const {
 /*
     if (C ==  NULL)
     {
-        TI->dump();
-        std::cout << B->getName().str() << " of " << B->getParent()->getName().str() << std::endl;
+        dumpValue(TI);
+        ielErr() << B->getName().str() << " of " << B->getParent()->getName().str() << std::endl;
     }
 */
     return C;
@@ -195,19 +246,18 @@ Instruction* ControlDependence::getBranchInstruction(BasicBlock* B) const {
 
 void ControlDependence::getAnalysisUsage(AnalysisUsage& AU) const {
     AU.setPreservesAll();
-    AU.addRequired<PostDominatorTree>();
+    AU.addRequired<ValueNumbering>();
 }
 
 //print - Show contents in human readable format...
 void ControlDependence::printDependences(std::ostream& O) const {
-    for (ControlDependentTy::const_iterator I = ControlDependents.begin(), 
-            E = ControlDependents.end(); I != E; ++I)
+    for (unsigned I = 0, E = ControlDependents.size(); I != E; ++I)
     {
-        const std::vector<BasicBlock*>& dependents = I->second;
+        const std::vector<BasicBlock*>& dependents = ControlDependents[I];
         for (std::vector<BasicBlock*>::const_iterator J = dependents.begin(),
                                                 F = dependents.end(); J != F; ++J)
         {
-            O << (*J)->getName().str() << " --> " << I->first->getName().str() << "\n";
+            O << (*J)->getName().str() << " --> " << Numbering->getBlock(I)->getName().str() << "\n";
         }
     }
 }
@@ -15,13 +15,16 @@
 #ifndef LLVM_CONTROLDEPENDENCE_H
 #define LLVM_CONTROLDEPENDENCE_H
 
+#include "../ValueNumbering/ValueNumbering.h"
 #include <vector>
-#include <map>
 #include <list>
 #include <queue>
 
 namespace llvm {
 
+class PostDominatorTree;
+class BitVector;
+
 //===----------------------------------------------------------------------===//
 //
 // ControlDependence class - This class computes the control dependences 
@@ -34,20 +37,32 @@ namespace llvm {
 //
 class ControlDependence : public FunctionPass {
     // type for representing control dependents - if a is control dependent on b
-    // then a will be in the vector for b
+    // then a will be in the vector for b. Indexed by the block number of b
     //
-    typedef std::map<BasicBlock*, std::vector<BasicBlock*> > ControlDependentTy;
+    typedef std::vector<std::vector<BasicBlock*> > ControlDependentTy;
     ControlDependentTy ControlDependents;
 
     // type for representing control dependency - if a is control dependent on b 
-    // then b will be in the vector for a
+    // then b will be in the vector for a. Indexed by the block number of a
     //
-    typedef std::map<BasicBlock*, std::vector<BasicBlock*> > ControlDependenceTy;
+    typedef std::vector<std::vector<BasicBlock*> > ControlDependenceTy;
     ControlDependenceTy ControlDependences;
 
+    const ValueNumbering* Numbering;
+    Function* CurrentFunction;
+    bool Computed;
+
+    // owned, built by compute instead of being required from the pass manager
+    // so that functions that are never queried do not pay for it
+    PostDominatorTree* PDT;
+
+    // compute the dependences of all blocks from the current post-dominator tree
+    void computeDependences(Function& F);
+
     public:
         static char ID;
-        ControlDependence() : FunctionPass(&ID) {}
+        ControlDependence() : FunctionPass(&ID), Numbering(NULL), CurrentFunction(NULL), Computed(false), PDT(NULL) {}
+        ~ControlDependence();
 
         //return true if B is control dependent on A
         bool isControlDependent(BasicBlock* B, BasicBlock* A) const;
@@ -60,15 +75,15 @@ class ControlDependence : public FunctionPass {
         // to enforce that without holding a reference to the function inside
         // the control dependence class
         //
-        std::vector<BasicBlock*> getControlDependences(BasicBlock* B) {
+        const std::vector<BasicBlock*>& getControlDependences(BasicBlock* B) const {
             assert(B != NULL && "Input block cannot be NULL");
-            return ControlDependences[B];
+            return ControlDependences[Numbering->getBlockNumber(B)];
         }
 
         //iterator for traversing the blocks on which P is control dependent
-        std::vector<BasicBlock*>::const_iterator dependence_begin(BasicBlock* P) { return ControlDependences[P].begin(); }
+        std::vector<BasicBlock*>::const_iterator dependence_begin(BasicBlock* P) const { return getControlDependences(P).begin(); }
 
-        std::vector<BasicBlock*>::const_iterator dependence_end(BasicBlock* P) { return ControlDependences[P].end(); }
+        std::vector<BasicBlock*>::const_iterator dependence_end(BasicBlock* P) const { return getControlDependences(P).end(); }
 
         // return the compare instructions on which instruction A is control dependent. This is basically the list
         // of all compare instructions in all the basic blocks on which the containing block of A is
@@ -76,16 +91,31 @@ class ControlDependence : public FunctionPass {
         //
         std::vector<Instruction*> getControlDependenceInstructions(Instruction* A);
 
-        // Compute control dependences for all blocks in this function
+        // Only remember F, the control dependences are computed by compute
         virtual bool runOnFunction(Function& F);
 
+        // Build the post-dominator tree and compute the control dependences of
+        // all blocks of the current function unless that was done already.
+        // Every query requires it
+        void compute();
+        bool isComputed() const { return Computed; }
+
+        // What runOnFunction does, for clients that run ControlDependence
+        // outside of a pass manager (see SILScheduler)
+        void setFunction(Function& F, const ValueNumbering& N);
+
+        // Recompute the control dependences after F was transformed. The
+        // ValueNumbering must have been renumbered already. The post-dominator
+        // tree is rebuilt, so all dependences are recomputed, but only the blocks
+        // whose dependences changed are set in AffectedBlocks
+        void update(Function& F, BitVector& AffectedBlocks);
+
         virtual void getAnalysisUsage(AnalysisUsage& AU) const;
 
         //print - Show contents in human readable format...
         void printDependences(std::ostream& O) const;
 
-    private:
-        
+        // return the instruction that decides which successor of B is executed
         Instruction* getBranchInstruction(BasicBlock* B) const;
 };
 
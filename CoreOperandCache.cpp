@@ -0,0 +1,29 @@
+#include "CoreOperandCache.h"
+#include "utils.h"
+
+using namespace llvm;
+
+CoreOperandCache::Index CoreOperandCache::resolve(Value* pointerOperand)
+{
+    DenseMap<Value*, Index>::iterator where = m_lookup.find(pointerOperand);
+    if (where != m_lookup.end())
+    {
+        return where->second;
+    }
+
+    Index i = m_entries.size();
+    m_entries.push_back(Entry());
+    Entry& entry = m_entries.back();
+
+    entry.coreOperandType = NULL;
+    findCoreOperand(pointerOperand, &entry.coreOperand, &entry.coreOperandType, &entry.indices);
+
+    m_lookup[pointerOperand] = i;
+    return i;
+}
+
+void CoreOperandCache::clear(void)
+{
+    m_lookup.clear();
+    m_entries.clear();
+}
@@ -0,0 +1,51 @@
+#include "llvm/Value.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "Span.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef COREOPERANDCACHE_H
+#define COREOPERANDCACHE_H
+
+//per function memo of findCoreOperand. Every pointer operand is resolved once, no
+//matter how many loads, stores and calls use it; the indices of an operand are kept
+//inline, there are rarely more than a few
+class CoreOperandCache
+{
+    public:
+
+        typedef unsigned int Index;
+
+        struct Entry
+        {
+            Value* coreOperand; //NULL if the pointer operand could not be resolved
+            const Type* coreOperandType;
+            SmallVector<Value*, 4> indices;
+        };
+
+        //return the resolution of pointerOperand, computing it the first time it is seen
+        Index resolve(Value* pointerOperand);
+
+        const Entry& get(Index i) const { return m_entries[i]; }
+        Value* getCoreOperand(Index i) const { return m_entries[i].coreOperand; }
+        const Type* getCoreOperandType(Index i) const { return m_entries[i].coreOperandType; }
+
+        //only valid until the next call to resolve
+        Span<Value*> getIndices(Index i) const
+        {
+            const SmallVector<Value*, 4>& indices = m_entries[i].indices;
+            return indices.empty() ? Span<Value*>() : Span<Value*>(indices.begin(), indices.end());
+        }
+
+        //the operands are keyed by address, so the cache must be cleared whenever
+        //values may have been deleted
+        void clear(void);
+
+    private:
+        DenseMap<Value*, Index> m_lookup;
+        std::vector<Entry> m_entries;
+};
+
+#endif //COREOPERANDCACHE_H
@@ -0,0 +1,101 @@
+#include "DebugLocIndex.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Analysis/DebugInfo.h"
+#include <algorithm>
+#include <climits>
+
+using namespace llvm;
+
+const unsigned int DebugLocIndex::NoFile;
+
+static void extend(std::pair<int, int>& range, const std::pair<int, int>& other)
+{
+    range.first = std::min(range.first, other.first);
+    range.second = std::max(range.second, other.second);
+}
+
+//a loop covers its blocks, so the range of every block is added to its innermost
+//loop and all the loops around that
+void DebugLocIndex::build(LoopInfo& loopInfo, const ValueNumbering& numbering)
+{
+    clear();
+    m_numbering = &numbering;
+
+    const std::pair<int, int> empty(INT_MAX, INT_MIN);
+    m_lines.assign(numbering.getNumInstructions(), -1);
+    m_blockRanges.assign(numbering.getNumBlocks(), empty);
+
+    if (numbering.getNumBlocks() == 0) return;
+
+    //the kind is looked up by name once instead of on every getMetadata("dbg")
+    unsigned int dbgKind = numbering.getBlock(0)->getContext().getMDKindID("dbg");
+
+    for (unsigned int i = 0; i < numbering.getNumInstructions(); ++i)
+    {
+        Instruction* inst = numbering.getInstruction(i);
+        if (MDNode* node = inst->getMetadata(dbgKind))
+        {
+            DILocation location(node);
+            m_lines[i] = location.getLineNumber();
+            extend(m_blockRanges[numbering.getBlockNumber(inst->getParent())], std::make_pair(m_lines[i], m_lines[i]));
+        }
+    }
+
+    for (unsigned int i = 0; i < numbering.getNumBlocks(); ++i)
+    {
+        BasicBlock* block = numbering.getBlock(i);
+        Loop* loop = loopInfo.getLoopFor(block);
+        if (loop == NULL) continue;
+
+        if (loop->getHeader() == block)
+        {
+            MDNode* node = block->getFirstNonPHI()->getMetadata(dbgKind);
+            m_loopFiles[loop] = node != NULL ? intern(DILocation(node).getFilename()) : NoFile;
+        }
+
+        for (; loop != NULL; loop = loop->getParentLoop())
+        {
+            std::pair<DenseMap<Loop*, std::pair<int, int> >::iterator, bool> where = m_loopRanges.insert(std::make_pair(loop, empty));
+            extend(where.first->second, m_blockRanges[i]);
+        }
+    }
+}
+
+void DebugLocIndex::clear(void)
+{
+    m_numbering = NULL;
+    m_lines.clear();
+    m_blockRanges.clear();
+    m_loopRanges.clear();
+    m_loopFiles.clear();
+}
+
+std::pair<int, int> DebugLocIndex::getLineRange(Loop* loop) const
+{
+    DenseMap<Loop*, std::pair<int, int> >::const_iterator where = m_loopRanges.find(loop);
+    assert(where != m_loopRanges.end() && "loop is not in the current function");
+    return where->second;
+}
+
+const std::string& DebugLocIndex::getSourceFile(Loop* loop) const
+{
+    static const std::string none;
+
+    DenseMap<Loop*, unsigned int>::const_iterator where = m_loopFiles.find(loop);
+    assert(where != m_loopFiles.end() && "loop is not in the current function");
+    return where->second != NoFile ? m_files[where->second] : none;
+}
+
+unsigned int DebugLocIndex::intern(StringRef name)
+{
+    StringMap<unsigned int>::iterator where = m_fileNumbers.find(name);
+    if (where != m_fileNumbers.end())
+    {
+        return where->second;
+    }
+
+    unsigned int file = m_files.size();
+    m_files.push_back(name.str());
+    m_fileNumbers[name] = file;
+    return file;
+}
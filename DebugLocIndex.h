@@ -0,0 +1,58 @@
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "ValueNumbering/ValueNumbering.h"
+#include <string>
+#include <vector>
+#include <deque>
+
+using namespace llvm;
+
+#ifndef DEBUGLOCINDEX_H
+#define DEBUGLOCINDEX_H
+
+//per function index of the debug locations. The dbg metadata of every instruction is
+//decoded once by build, after that the line of an instruction and the line range and
+//source file of a loop are array or hash lookups. The instructions and blocks are
+//identified by the numbers given by the ValueNumbering pass.
+//
+//Source file names are interned in a string table that is kept across functions, so
+//the references getSourceFile returns stay valid as long as the index
+class DebugLocIndex
+{
+    public:
+
+        static const unsigned int NoFile = ~0U;
+
+        DebugLocIndex() : m_numbering(NULL) {}
+
+        void build(LoopInfo& loopInfo, const ValueNumbering& numbering);
+        void clear(void);
+
+        //-1 if inst has no location
+        int getLine(Instruction* inst) const { return m_lines[m_numbering->getInstructionNumber(inst)]; }
+
+        //the smallest and largest line of the instructions of block or loop, like
+        //getLineNumber(Loop*) they are INT_MAX and INT_MIN if no instruction has a location
+        std::pair<int, int> getLineRange(BasicBlock* block) const { return m_blockRanges[m_numbering->getBlockNumber(block)]; }
+        std::pair<int, int> getLineRange(Loop* loop) const;
+
+        //the file of the first instruction of the header of loop that is not a phi node,
+        //empty if it has no location
+        const std::string& getSourceFile(Loop* loop) const;
+
+    private:
+        unsigned int intern(StringRef name);
+
+    private:
+        const ValueNumbering* m_numbering;
+        std::vector<int> m_lines; //per instruction number
+        std::vector<std::pair<int, int> > m_blockRanges; //per block number
+        DenseMap<Loop*, std::pair<int, int> > m_loopRanges;
+        DenseMap<Loop*, unsigned int> m_loopFiles;
+
+        StringMap<unsigned int> m_fileNumbers;
+        std::deque<std::string> m_files; //push_back does not move the names
+};
+
+#endif //DEBUGLOCINDEX_H
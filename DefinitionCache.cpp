@@ -0,0 +1,164 @@
+#include "DefinitionCache.h"
+
+using namespace llvm;
+
+void DefinitionCache::reset(ReachingDef* reachingDef)
+{
+    m_reachingDef = reachingDef;
+    m_ranges.clear();
+    m_definitions.clear();
+    m_definitionParents.clear();
+}
+
+//return false once either budget is used up
+bool DefinitionCache::charge(uint64_t units)
+{
+    if (m_loopBudget == NULL) return true;
+
+    bool loopLeft = m_loopBudget->charge(units);
+    bool functionLeft = m_functionBudget->charge(units);
+
+    return loopLeft && functionLeft;
+}
+
+bool DefinitionCache::isExceeded(void) const
+{
+    return m_loopBudget != NULL && (m_loopBudget->isExceeded() || m_functionBudget->isExceeded());
+}
+
+void DefinitionCache::addDefinition(BufferRange& range, Value* value, BasicBlock* parent)
+{
+    BufferRange parentRange = range;
+
+    appendToRange(m_definitions, range, value);
+    appendToRange(m_definitionParents, parentRange, parent);
+
+    assert(m_definitions.size() == m_definitionParents.size());
+}
+
+BufferRange DefinitionCache::lookup(Value* value)
+{
+    assert(m_reachingDef != NULL);
+
+    DenseMap<Value*, BufferRange>::iterator where = m_ranges.find(value);
+    if (where != m_ranges.end())
+    {
+        return where->second;
+    }
+
+    BufferRange range;
+
+    if (PHINode* phiNode = dyn_cast<PHINode>(value))
+    {
+        flattenPhiWeb(phiNode, range);
+    }
+    else if (isa<LoadInst>(value) || isa<CallInst>(value) || isa<InvokeInst>(value))
+    {
+        //a call that reads memory is treated like a load of what it reads
+        Instruction* user = cast<Instruction>(value);
+        Span<Instruction*> definitions = m_reachingDef->getDefinitions(user);
+        charge(1 + definitions.size());
+
+        //TODO:is this really required?
+        addDefinition(range, value, user->getParent());
+
+        for (Span<Instruction*>::iterator i = definitions.begin(); i != definitions.end(); ++i)
+        {
+            addDefinition(range, *i, (*i)->getParent());
+        }
+    }
+    else
+    {
+        addDefinition(range, value, cast<Instruction>(value)->getParent());
+    }
+
+    //a list cut short by the budget would be wrong for the next loop
+    if (!isExceeded())
+    {
+        m_ranges[value] = range;
+    }
+
+    return range;
+}
+
+//collect all the non phi values that flow into root. Phi nodes whose lists are
+//already in the cache are not walked again, their lists are copied instead
+void DefinitionCache::flattenPhiWeb(PHINode* root, BufferRange& range)
+{
+    m_visited.clear();
+    m_seen.clear();
+    m_pending.clear();
+
+    flattenPhiWeb(root, root);
+
+    //the cached lists copied above were read from the buffer, so the new list
+    //is only appended once the walk is done
+    for (std::vector<DefinitionParentPair>::iterator i = m_pending.begin(); i != m_pending.end(); ++i)
+    {
+        addDefinition(range, i->first, i->second);
+    }
+}
+
+void DefinitionCache::flattenPhiWeb(PHINode* phiNode, PHINode* root)
+{
+    m_visited.insert(phiNode);
+    if (!charge(1)) return;
+
+    if (phiNode != root)
+    {
+        DenseMap<Value*, BufferRange>::iterator where = m_ranges.find(phiNode);
+        if (where != m_ranges.end())
+        {
+            Span<Value*> definitions = getDefinitions(where->second);
+            Span<BasicBlock*> parents = getDefinitionParents(where->second);
+            if (!charge(definitions.size())) return;
+
+            for (unsigned int i = 0; i < definitions.size(); ++i)
+            {
+                DefinitionParentPair pair(definitions[i], parents[i]);
+                if (m_seen.insert(pair).second)
+                {
+                    m_pending.push_back(pair);
+                }
+            }
+
+            return;
+        }
+    }
+
+    unsigned int incomingSize = phiNode->getNumIncomingValues();
+    for (unsigned int i = 0; i < incomingSize; ++i)
+    {
+        Value* value = phiNode->getIncomingValue(i);
+
+        if (isExceeded()) return;
+        if (isa<UndefValue>(value)) continue;
+        assert(!isa<BasicBlock>(value));
+
+        if (PHINode* valueAsPhiNode = dyn_cast<PHINode>(value))
+        {
+            if (m_visited.count(valueAsPhiNode) == 0)
+            {
+                flattenPhiWeb(valueAsPhiNode, root);
+            }
+
+            continue;
+        }
+
+        DefinitionParentPair pair(value, NULL);
+        if (Instruction* inst = dyn_cast<Instruction>(value))
+        {
+            pair.second = inst->getParent();
+        }
+        else
+        {
+            pair.second = phiNode->getIncomingBlock(i);
+        }
+
+        if (m_seen.insert(pair).second)
+        {
+            m_pending.push_back(pair);
+            charge(1);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "ReachingDef/ReachingDef.h"
+#include "AnalysisBudget.h"
+#include "Span.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef DEFINITIONCACHE_H
+#define DEFINITIONCACHE_H
+
+//per function cache of the definition list of every value used in a loop, together
+//with the blocks those definitions belong to. Phi webs are flattened once, loads and
+//calls get their reaching stores and calls once, and all SI/L parameters of the
+//function refer to the same lists.
+//
+//Resolving a list is charged to the budgets given to setBudgets, one unit per phi
+//node and definition walked. Once they are used up the walk stops, and the partial
+//list is returned but not kept
+class DefinitionCache
+{
+    public:
+
+        DefinitionCache() : m_reachingDef(NULL), m_loopBudget(NULL), m_functionBudget(NULL) {}
+
+        void setBudgets(AnalysisBudget* loopBudget, AnalysisBudget* functionBudget)
+        {
+            m_loopBudget = loopBudget;
+            m_functionBudget = functionBudget;
+        }
+
+        //drop everything computed for the previous function
+        void reset(ReachingDef* reachingDef);
+
+        //forget the lists after the function was transformed, but keep the buffers so
+        //that the ranges handed out before stay valid
+        void invalidate(void) { m_ranges.clear(); }
+
+        //return the definitions of value, resolving them the first time value is seen
+        BufferRange lookup(Value* value);
+
+        Span<Value*> getDefinitions(const BufferRange& range) const { return makeSpan(m_definitions, range); }
+        Span<BasicBlock*> getDefinitionParents(const BufferRange& range) const { return makeSpan(m_definitionParents, range); }
+
+    private:
+        bool charge(uint64_t units);
+        bool isExceeded(void) const;
+        void addDefinition(BufferRange& range, Value* value, BasicBlock* parent);
+        void flattenPhiWeb(PHINode* root, BufferRange& range);
+        void flattenPhiWeb(PHINode* phiNode, PHINode* root);
+
+    private:
+        typedef std::pair<Value*, BasicBlock*> DefinitionParentPair;
+
+        ReachingDef* m_reachingDef;
+        AnalysisBudget* m_loopBudget;
+        AnalysisBudget* m_functionBudget;
+        DenseMap<Value*, BufferRange> m_ranges;
+
+        std::vector<Value*> m_definitions;
+        std::vector<BasicBlock*> m_definitionParents;
+
+        //scratch space for flattenPhiWeb, kept around to avoid reallocating it
+        DenseSet<PHINode*> m_visited;
+        DenseSet<DefinitionParentPair> m_seen;
+        std::vector<DefinitionParentPair> m_pending;
+};
+
+#endif //DEFINITIONCACHE_H
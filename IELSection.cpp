@@ -2,11 +2,15 @@
 #include "llvm/Analysis/DebugInfo.h"
 #include "utils.h"
 #include <string>
+#include <sstream>
 
 using namespace llvm;
 
-IELSection::IELSection(Loop* loop, int id)
+IELSection::IELSection(Loop* loop, LoopBlockSet loopBlocks, DefinitionCache* definitionCache, const DebugLocIndex* debugLocs, int id)
     :   m_loop(loop), 
+        m_header(loop->getHeader()),
+        m_loopBlocks(loopBlocks),
+        m_silParameters(loop, loopBlocks, definitionCache, debugLocs),
         m_isIELSection(false), 
         m_id(id)
 {
@@ -14,28 +18,28 @@ IELSection::IELSection(Loop* loop, int id)
 
 IELSection::~IELSection()
 {
-    for (unsigned int i = 0; i < m_silParameters.size(); ++i)
-    {
-        delete m_silParameters[i];
-    }
 }
 
-void IELSection::addSILParameter(SILParameter* silParameter)
+void IELSection::rebind(Loop* loop, LoopBlockSet loopBlocks)
 {
-    assert(silParameter != NULL);
-    m_silParameters.push_back(silParameter);
-    m_silParametersMap[silParameter->getValue()] = silParameter;
+    assert(loop->getHeader() == m_header);
+
+    m_loop = loop;
+    m_loopBlocks = loopBlocks;
+    m_silParameters.rebind(loop, loopBlocks);
 }
 
-SILParameter* IELSection::getSILParameter(Value* value) 
-{ 
-    std::map<Value*, SILParameter*>::iterator where = m_silParametersMap.find(value);
-    if (where != m_silParametersMap.end())
+void IELSection::addCheckSite(SILParameterTable::Index parameter, CheckSite::Kind kind)
+{
+    assert(parameter < m_silParameters.size());
+    m_checkSites.push_back(CheckSite(parameter, kind));
+
+    if (m_isCheckSite.size() != m_silParameters.size())
     {
-        return where->second;
+        m_isCheckSite.resize(m_silParameters.size(), false);
     }
 
-    return NULL;
+    m_isCheckSite[parameter] = true;
 }
 
 bool IELSection::usedInLoadStore(GetElementPtrInst* instr)
@@ -68,12 +72,11 @@ void IELSection::usedInLoadStore(GetElementPtrInst* instr, bool &result)
     }
 }
 
-void IELSection::printIELSection(void)
+void IELSection::printIELSection(const IELSectionRecord& record)
 {
     if (m_isIELSection)
     {
-        print();
-        std::cerr << std::endl;
+        print(record);
     }
 }
 
@@ -104,26 +107,16 @@ void IELSection::generateGraphVizFile(std::fstream& file)
     }
 }
 
-void IELSection::print(void)
+//the lines are collected first, so that an unbuffered stream gets a single write
+void IELSection::print(const IELSectionRecord& record)
 {
-    //SILParameterList& silParameters = getSILParameters();
-    std::pair<int, int> range = getLineNumber(m_loop);
-    
-    std::cerr << "Line no: " << range.first << std::endl;
-    std::cerr << "Range: " << range.first << "-" << range.second << "\nSource file: " << getSourceFile(m_loop) << std::endl;
-    std::cerr << "Loop header: " << m_loop->getHeader()->getName().str() << std::endl;
-    std::cerr << "Function: " << m_loop->getHeader()->getParent()->getName().str() << std::endl;
-    //std::cout << "\nSil parameters: " << silParameters.size() << std::endl;
-
-    /*
-       for (SILParameterList::iterator i = silParameters.begin(); i != silParameters.end(); ++i)
-       {
-       SILParameter* currentParameter = *i;
-       std::cout << "Value: " << *currentParameter->getValue() << "\n"
-       << "Instruction: " << *currentParameter->getInstruction() << "\n"
-       << "SI/L: " << MapEnum2Str[currentParameter->getSILValue()] << "\n"
-       << "--------------------\n";
-       }
-     */
+    std::ostringstream os;
+
+    os << "Line no: " << record.firstLine << "\n";
+    os << "Range: " << record.firstLine << "-" << record.lastLine << "\nSource file: " << record.sourceFile << "\n";
+    os << "Loop header: " << record.header << "\n";
+    os << "Function: " << record.function << "\n\n";
+
+    ielErr() << os.str();
 }
 
@@ -5,6 +5,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Type.h"
 #include "SILParameter.h"
+#include "IELSectionRecord.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -18,36 +19,69 @@ using namespace llvm;
 class IELSection
 {
     public:
+
+        //a parameter whose SI/L value decides if the loop is an IE/L section
+        struct CheckSite
+        {
+            enum Kind
+            {
+                ArrayIndex,
+                Branch
+            };
+
+            CheckSite(SILParameterTable::Index parameter, Kind kind) : parameter(parameter), kind(kind) {}
+
+            SILParameterTable::Index parameter;
+            Kind kind;
+        };
     
-        IELSection(Loop* loop, int id);
+        IELSection(Loop* loop, LoopBlockSet loopBlocks, DefinitionCache* definitionCache, const DebugLocIndex* debugLocs, int id);
         ~IELSection();
         int getId(void) { return m_id; }
 
         bool isIELSection(void) { return m_isIELSection; }
         void setIELSection(bool isIELSection) { m_isIELSection = isIELSection; }
         void addBlock(BasicBlock* block) {  m_blocks.push_back(block); }
-        std::vector<BasicBlock*> getBlocks() { return m_blocks; }
+        const std::vector<BasicBlock*>& getBlocks() const { return m_blocks; }
+
+        //return true if block is one of the blocks returned by getBlocks
+        bool isInBody(BasicBlock* block) const { return m_loopBlocks.isInBody(block); }
 
-        void addSILParameter(SILParameter* silParameter);
-        SILParameter* getSILParameter(Value* value);
+        SILParameterTable::Index addSILParameter(Value* value, Instruction* s) { return m_silParameters.add(value, s); }
+        SILParameterTable::Index getSILParameter(Value* value) const { return m_silParameters.lookup(value); }
         
+        void addCheckSite(SILParameterTable::Index parameter, CheckSite::Kind kind);
+        const std::vector<CheckSite>& getCheckSites(void) const { return m_checkSites; }
+        bool isCheckSite(SILParameterTable::Index parameter) const { return parameter < m_isCheckSite.size() && m_isCheckSite[parameter]; }
+
         size_t size(void) const { return m_silParameters.size(); }
 
         Loop* getLoop(void) { return m_loop; }
-        SILParameterList& getSILParameters(void) { return m_silParameters; }
+
+        //the header of the loop at the time the section was created, it can still be
+        //compared after the loop itself was freed by a transformation
+        BasicBlock* getHeader(void) const { return m_header; }
+
+        //see SIL::update
+        void rebind(Loop* loop, LoopBlockSet loopBlocks);
+        SILParameterTable& getSILParameters(void) { return m_silParameters; }
 
         bool usedInLoadStore(GetElementPtrInst* instr);
-        void printIELSection(void);
+        //the lines and file are taken from the record of the section, which has them already
+        void printIELSection(const IELSectionRecord& record);
 	void generateGraphVizFile(std::fstream& file);
-        void print(void);
+        void print(const IELSectionRecord& record);
 
     private:
         void usedInLoadStore(GetElementPtrInst* instr, bool &result);
 
     private:
         Loop* m_loop;
-        SILParameterList m_silParameters;
-        std::map<Value*, SILParameter*> m_silParametersMap;
+        BasicBlock* m_header;
+        LoopBlockSet m_loopBlocks;
+        SILParameterTable m_silParameters;
+        std::vector<CheckSite> m_checkSites;
+        std::vector<bool> m_isCheckSite;
         std::vector<BasicBlock*> m_blocks;
         bool m_isIELSection;
         int m_id;
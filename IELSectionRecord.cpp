@@ -0,0 +1,125 @@
+#include "IELSectionRecord.h"
+#include "DebugLocIndex.h"
+#include <sstream>
+
+using namespace llvm;
+
+IELSectionRecord::IELSectionRecord(Loop* loop, const DebugLocIndex& debugLocs, Verdict verdict, unsigned int numParameters, unsigned int numCheckSites)
+    :   function(loop->getHeader()->getParent()->getName().str()),
+        header(loop->getHeader()->getName().str()),
+        sourceFile(debugLocs.getSourceFile(loop)),
+        verdict(verdict),
+        numParameters(numParameters),
+        numCheckSites(numCheckSites),
+        rejectionStep(NotRejected),
+        microseconds(0)
+{
+    std::pair<int, int> range = debugLocs.getLineRange(loop);
+    firstLine = range.first;
+    lastLine = range.second;
+}
+
+const char* IELSectionRecord::getVerdictName(Verdict verdict)
+{
+    switch (verdict)
+    {
+        case Accepted:
+            return "accepted";
+
+        case Rejected:
+            return "rejected";
+
+        case BudgetExceeded:
+            return "budget-exceeded";
+
+        case Cold:
+            return "cold";
+    }
+
+    assert(false && "unknown verdict");
+    return "";
+}
+
+const char* IELSectionRecord::getRejectionStepName(RejectionStep rejectionStep)
+{
+    switch (rejectionStep)
+    {
+        case NotRejected:
+            return "-";
+
+        case RejectedInStep1:
+            return "step1";
+
+        case RejectedInStep2:
+            return "step2";
+
+        case RejectedInFinalCheck:
+            return "final-check";
+    }
+
+    assert(false && "unknown rejection step");
+    return "";
+}
+
+void IELSectionRecord::print(std::ostream& os) const
+{
+    os << function << " " << header << " " << firstLine << "-" << lastLine << " "
+       << (sourceFile.empty() ? "-" : sourceFile) << " " << getVerdictName(verdict) << " "
+       << numParameters << " " << numCheckSites << "\n";
+}
+
+void IELSectionRecord::printWithTiming(std::ostream& os) const
+{
+    os << function << " " << header << " " << firstLine << "-" << lastLine << " "
+       << (sourceFile.empty() ? "-" : sourceFile) << " " << getVerdictName(verdict) << " "
+       << numParameters << " " << numCheckSites << " "
+       << getRejectionStepName(rejectionStep) << " " << microseconds << "\n";
+}
+
+bool IELSectionRecord::parse(const std::string& line)
+{
+    std::istringstream fields(line);
+    std::string verdictName;
+    char dash;
+
+    if (!(fields >> function >> header >> firstLine >> dash >> lastLine >> sourceFile >> verdictName >> numParameters >> numCheckSites) || dash != '-')
+    {
+        return false;
+    }
+
+    if (sourceFile == "-")
+    {
+        sourceFile.clear();
+    }
+
+    bool isKnown = false;
+    for (int i = Accepted; i <= Cold && !isKnown; ++i)
+    {
+        if (verdictName == getVerdictName((Verdict)i))
+        {
+            verdict = (Verdict)i;
+            isKnown = true;
+        }
+    }
+
+    if (!isKnown) return false;
+
+    //the fields of printWithTiming are optional
+    std::string stepName;
+    rejectionStep = NotRejected;
+    microseconds = 0;
+
+    if (!(fields >> stepName)) return true;
+    if (!(fields >> microseconds)) return false;
+
+    for (int i = NotRejected; i <= RejectedInFinalCheck; ++i)
+    {
+        if (stepName == getRejectionStepName((RejectionStep)i))
+        {
+            rejectionStep = (RejectionStep)i;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,64 @@
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/System/DataTypes.h"
+#include <string>
+#include <ostream>
+
+using namespace llvm;
+
+#ifndef IELSECTIONRECORD_H
+#define IELSECTIONRECORD_H
+
+class DebugLocIndex;
+
+//self contained summary of the analysis of one loop. Unlike IELSection it holds no
+//pointers into the IR, so it stays valid after the function has been released
+struct IELSectionRecord
+{
+    enum Verdict
+    {
+        Accepted,
+        Rejected,
+        BudgetExceeded,
+        Cold //not analysed because the profile says it rarely runs
+    };
+
+    //where the analysis rejected the loop, see SIL::checkLoop
+    enum RejectionStep
+    {
+        NotRejected,
+        RejectedInStep1,
+        RejectedInStep2,
+        RejectedInFinalCheck
+    };
+
+    IELSectionRecord() : firstLine(-1), lastLine(-1), verdict(Rejected), numParameters(0), numCheckSites(0), rejectionStep(NotRejected), microseconds(0) {}
+    IELSectionRecord(Loop* loop, const DebugLocIndex& debugLocs, Verdict verdict, unsigned int numParameters, unsigned int numCheckSites);
+
+    bool isIELSection(void) const { return verdict == Accepted; }
+
+    //one line, space separated: function header first-last file verdict parameters checksites
+    void print(std::ostream& os) const;
+    //the same line followed by the rejection step and the time. It is kept out of
+    //print, so that the reports of two runs can be compared
+    void printWithTiming(std::ostream& os) const;
+
+    //read a line written by print or printWithTiming, return false if it is malformed
+    bool parse(const std::string& line);
+
+    static const char* getVerdictName(Verdict verdict);
+    static const char* getRejectionStepName(RejectionStep rejectionStep);
+
+    std::string function;
+    std::string header;
+    std::string sourceFile;
+    int firstLine;
+    int lastLine;
+    Verdict verdict;
+    unsigned int numParameters;
+    unsigned int numCheckSites;
+    RejectionStep rejectionStep;
+    //wall time spent on the loop
+    uint64_t microseconds;
+};
+
+#endif //IELSECTIONRECORD_H
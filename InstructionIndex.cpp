@@ -0,0 +1,106 @@
+#include "InstructionIndex.h"
+
+using namespace llvm;
+
+void InstructionIndex::build(Function& function, const ValueNumbering& numbering, const ModRef& modRef, CoreOperandCache& coreOperands)
+{
+    clear();
+    m_numbering = &numbering;
+    m_coreOperands = &coreOperands;
+    m_blocks.reserve(numbering.getNumBlocks());
+    m_stores.reserve(numbering.getNumStores());
+
+    for (Function::iterator block = function.begin(); block != function.end(); ++block)
+    {
+        assert(numbering.getBlockNumber(block) == m_blocks.size());
+        m_blocks.push_back(BlockEntry());
+        BlockEntry& blockEntry = m_blocks.back();
+
+        blockEntry.stores.begin = m_stores.size();
+        blockEntry.loads.begin = m_loads.size();
+        blockEntry.phiNodes.begin = m_phiNodes.size();
+        blockEntry.users.begin = m_users.size();
+        blockEntry.calls.begin = m_calls.size();
+
+        for (BasicBlock::iterator instr = block->begin(); instr != block->end(); ++instr)
+        {
+            if (PHINode* phiNode = dyn_cast<PHINode>(instr))
+            {
+                m_phiNodes.push_back(phiNode);
+                continue;
+            }
+
+            if (instr->getNumOperands() != 0)
+            {
+                m_users.push_back(instr);
+            }
+
+            if (StoreInst* storeInst = dyn_cast<StoreInst>(instr))
+            {
+                StoreEntry entry;
+                entry.store = storeInst;
+
+                CoreOperandCache::Index resolution = coreOperands.resolve(storeInst->getPointerOperand());
+                entry.coreOperand = coreOperands.getCoreOperand(resolution);
+                entry.coreOperandType = coreOperands.getCoreOperandType(resolution);
+
+                assert(numbering.getStoreNumber(storeInst) == m_stores.size());
+                m_stores.push_back(entry);
+            }
+            else if (LoadInst* loadInst = dyn_cast<LoadInst>(instr))
+            {
+                LoadEntry entry;
+                entry.load = loadInst;
+                entry.resolution = coreOperands.resolve(loadInst->getPointerOperand());
+                entry.coreOperand = coreOperands.getCoreOperand(entry.resolution);
+
+                m_loads.push_back(entry);
+            }
+            else if (isa<CallInst>(instr) || isa<InvokeInst>(instr))
+            {
+                CallEffects effects;
+                modRef.getCallEffects(CallSite::get(instr), effects, &coreOperands);
+                if (effects.empty()) continue;
+
+                CallEntry entry;
+                entry.call = instr;
+                entry.modUnknown = effects.ModUnknown;
+                entry.refUnknown = effects.RefUnknown;
+
+                entry.mod.begin = m_roots.size();
+                m_roots.insert(m_roots.end(), effects.Mod.begin(), effects.Mod.end());
+                entry.mod.end = entry.ref.begin = m_roots.size();
+                m_roots.insert(m_roots.end(), effects.Ref.begin(), effects.Ref.end());
+                entry.ref.end = m_roots.size();
+
+                m_calls.push_back(entry);
+            }
+            else if (BranchInst* branchInst = dyn_cast<BranchInst>(instr))
+            {
+                if (branchInst->isConditional())
+                {
+                    blockEntry.conditionalBranch = branchInst;
+                }
+            }
+        }
+
+        blockEntry.stores.end = m_stores.size();
+        blockEntry.loads.end = m_loads.size();
+        blockEntry.phiNodes.end = m_phiNodes.size();
+        blockEntry.users.end = m_users.size();
+        blockEntry.calls.end = m_calls.size();
+    }
+}
+
+void InstructionIndex::clear(void)
+{
+    m_numbering = NULL;
+    m_coreOperands = NULL;
+    m_blocks.clear();
+    m_stores.clear();
+    m_loads.clear();
+    m_phiNodes.clear();
+    m_users.clear();
+    m_calls.clear();
+    m_roots.clear();
+}
@@ -0,0 +1,111 @@
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "Span.h"
+#include "CoreOperandCache.h"
+#include "ValueNumbering/ValueNumbering.h"
+#include "ModRef/ModRef.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef INSTRUCTIONINDEX_H
+#define INSTRUCTIONINDEX_H
+
+//per function classification of the instructions the ielsections passes look at.
+//It is built in a single walk over the function. For every block it keeps the
+//stores, loads, phi nodes and non phi instructions of the block, in block order,
+//together with the core operands of the loads and stores, resolved through a
+//CoreOperandCache, so that the passes don't have to walk the IR and resolve
+//pointer operands again. Blocks and stores are kept in the order of their
+//ValueNumbering numbers. Calls that may access memory are kept with the core
+//operands they may write and read
+class InstructionIndex
+{
+    public:
+
+        struct StoreEntry
+        {
+            StoreInst* store;
+            Value* coreOperand; //NULL if the target of the store could not be resolved
+            const Type* coreOperandType;
+        };
+
+        struct LoadEntry
+        {
+            LoadInst* load;
+            Value* coreOperand; //NULL if the source of the load could not be resolved
+            CoreOperandCache::Index resolution;
+        };
+
+        struct CallEntry
+        {
+            Instruction* call;
+            BufferRange mod;
+            BufferRange ref;
+            bool modUnknown; //the call may write every global and argument
+            bool refUnknown; //the call may read every global and argument
+        };
+
+        InstructionIndex() : m_numbering(NULL), m_coreOperands(NULL) {}
+
+        //coreOperands must stay alive and must not be cleared while the index is used
+        void build(Function& function, const ValueNumbering& numbering, const ModRef& modRef, CoreOperandCache& coreOperands);
+        void clear(void);
+
+        Span<StoreEntry> getStores(BasicBlock* block) const { return makeSpan(m_stores, getBlock(block).stores); }
+        Span<LoadEntry> getLoads(BasicBlock* block) const { return makeSpan(m_loads, getBlock(block).loads); }
+        Span<PHINode*> getPhiNodes(BasicBlock* block) const { return makeSpan(m_phiNodes, getBlock(block).phiNodes); }
+
+        //all the instructions of block that are not phi nodes and have operands
+        Span<Instruction*> getUsers(BasicBlock* block) const { return makeSpan(m_users, getBlock(block).users); }
+
+        //the terminator of block if it is a conditional branch, NULL otherwise
+        BranchInst* getConditionalBranch(BasicBlock* block) const { return getBlock(block).conditionalBranch; }
+
+        //the array indices used to compute the address a load reads from
+        Span<Value*> getIndices(const LoadEntry& load) const { return m_coreOperands->getIndices(load.resolution); }
+
+        const StoreEntry& getStore(StoreInst* store) const { return m_stores[m_numbering->getStoreNumber(store)]; }
+
+        //number is a store number of the ValueNumbering the index was built with
+        const StoreEntry& getStore(unsigned int number) const { return m_stores[number]; }
+
+        //the calls of block that may access memory, numbered in function order
+        Span<CallEntry> getCalls(BasicBlock* block) const { return makeSpan(m_calls, getBlock(block).calls); }
+        unsigned int getNumCalls(void) const { return m_calls.size(); }
+        const CallEntry& getCall(unsigned int number) const { return m_calls[number]; }
+        unsigned int getCallNumber(const CallEntry& call) const { return &call - &m_calls[0]; }
+
+        Span<Value*> getModRoots(const CallEntry& call) const { return makeSpan(m_roots, call.mod); }
+        Span<Value*> getRefRoots(const CallEntry& call) const { return makeSpan(m_roots, call.ref); }
+
+    private:
+
+        struct BlockEntry
+        {
+            BlockEntry() : conditionalBranch(NULL) {}
+
+            BufferRange stores;
+            BufferRange loads;
+            BufferRange phiNodes;
+            BufferRange users;
+            BufferRange calls;
+            BranchInst* conditionalBranch;
+        };
+
+        const BlockEntry& getBlock(BasicBlock* block) const { return m_blocks[m_numbering->getBlockNumber(block)]; }
+
+    private:
+        const ValueNumbering* m_numbering;
+        const CoreOperandCache* m_coreOperands;
+        std::vector<BlockEntry> m_blocks;
+
+        std::vector<StoreEntry> m_stores;
+        std::vector<LoadEntry> m_loads;
+        std::vector<PHINode*> m_phiNodes;
+        std::vector<Instruction*> m_users;
+        std::vector<CallEntry> m_calls;
+        std::vector<Value*> m_roots;
+};
+
+#endif //INSTRUCTIONINDEX_H
@@ -0,0 +1,47 @@
+#include "LoopMembership.h"
+
+using namespace llvm;
+
+void LoopMembership::build(LoopInfo& loopInfo, const ValueNumbering& numbering)
+{
+    clear();
+    m_numbering = &numbering;
+
+    for (LoopInfo::iterator i = loopInfo.begin(); i != loopInfo.end(); ++i)
+    {
+        addLoop(*i);
+    }
+}
+
+void LoopMembership::clear(void)
+{
+    m_numbering = NULL;
+    m_loopNumbers.clear();
+    m_loopBlocks.clear();
+}
+
+void LoopMembership::addLoop(Loop* loop)
+{
+    m_loopNumbers[loop] = m_loopBlocks.size();
+    m_loopBlocks.push_back(BitVector(getNumBlocks()));
+    BitVector& blocks = m_loopBlocks.back();
+
+    for (LoopBase<BasicBlock, Loop>::block_iterator i = loop->block_begin(); i != loop->block_end(); ++i)
+    {
+        blocks.set(getBlockNumber(*i));
+    }
+
+    const std::vector<Loop*>& subLoops = loop->getSubLoops();
+    for (std::vector<Loop*>::const_iterator i = subLoops.begin(); i != subLoops.end(); ++i)
+    {
+        addLoop(*i);
+    }
+}
+
+LoopBlockSet LoopMembership::getBlockSet(Loop* loop) const
+{
+    DenseMap<Loop*, unsigned int>::const_iterator where = m_loopNumbers.find(loop);
+    assert(where != m_loopNumbers.end() && "loop is not in the current function");
+
+    return LoopBlockSet(this, &m_loopBlocks[where->second], getBlockNumber(loop->getHeader()));
+}
@@ -0,0 +1,78 @@
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "ValueNumbering/ValueNumbering.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef LOOPMEMBERSHIP_H
+#define LOOPMEMBERSHIP_H
+
+class LoopMembership;
+
+//the blocks of one loop, as a bit vector over the block numbers of its function
+class LoopBlockSet
+{
+    public:
+
+        LoopBlockSet() : m_membership(NULL), m_blocks(NULL), m_header(0) {}
+        LoopBlockSet(const LoopMembership* membership, const BitVector* blocks, unsigned int header)
+            :   m_membership(membership),
+                m_blocks(blocks),
+                m_header(header)
+        {
+        }
+
+        bool contains(BasicBlock* block) const;
+
+        //return true if block is in the loop but is not its header
+        bool isInBody(BasicBlock* block) const;
+
+    private:
+        const LoopMembership* m_membership;
+        const BitVector* m_blocks;
+        unsigned int m_header;
+};
+
+//per function index that answers "is this block in that loop" in constant time.
+//Every loop of the function gets a bit vector over the block numbers given by
+//the ValueNumbering pass
+class LoopMembership
+{
+    public:
+
+        LoopMembership() : m_numbering(NULL) {}
+
+        void build(LoopInfo& loopInfo, const ValueNumbering& numbering);
+        void clear(void);
+
+        unsigned int getNumBlocks(void) const { return m_numbering->getNumBlocks(); }
+        unsigned int getBlockNumber(BasicBlock* block) const { return m_numbering->getBlockNumber(block); }
+
+        //only valid until the next call to build or clear
+        LoopBlockSet getBlockSet(Loop* loop) const;
+
+    private:
+        void addLoop(Loop* loop);
+
+    private:
+        const ValueNumbering* m_numbering;
+        DenseMap<Loop*, unsigned int> m_loopNumbers;
+        std::vector<BitVector> m_loopBlocks;
+};
+
+inline bool LoopBlockSet::contains(BasicBlock* block) const
+{
+    assert(m_blocks != NULL);
+    return m_blocks->test(m_membership->getBlockNumber(block));
+}
+
+inline bool LoopBlockSet::isInBody(BasicBlock* block) const
+{
+    assert(m_blocks != NULL);
+    unsigned int number = m_membership->getBlockNumber(block);
+    return number != m_header && m_blocks->test(number);
+}
+
+#endif //LOOPMEMBERSHIP_H
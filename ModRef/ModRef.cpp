@@ -0,0 +1,344 @@
+//===-- ModRef.cpp - ModRef class code ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the defintion of the ModRef class, which is used for
+// computing interprocedural mod/ref summaries.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InstIterator.h"
+#include "ModRef.h"
+#include "../utils.h"
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+ModRefThreads("modref-threads", cl::desc("Number of threads computing mod/ref summaries (0 = one per processor)"), cl::init(0));
+
+char ModRef::ID;
+static RegisterPass<ModRef>
+C("modref", "Compute interprocedural mod/ref summaries", false, true);
+
+namespace {
+    // the components of one level, handed out to the worker threads one at a time
+    struct LevelWork {
+        ModRef* Pass;
+        const std::vector<unsigned>* SCCs;
+        unsigned Next;
+        pthread_mutex_t Lock;
+    };
+}
+
+// return the core operand of Pointer or NULL if it cannot be resolved
+//
+static Value* getRoot(Value* Pointer, CoreOperandCache* Cache) {
+    if (!isa<PointerType>(Pointer->getType()))
+        return NULL;
+
+    if (Cache != NULL)
+        return Cache->getCoreOperand(Cache->resolve(Pointer));
+
+    Value* Core = NULL;
+    findCoreOperand(Pointer, &Core);
+    return Core;
+}
+
+// record that Root of the current function is accessed. Allocas are local to
+// the function, so they are not visible to the callers
+//
+static void addRoot(Value* Root, std::vector<GlobalVariable*>& Globals,
+                    std::vector<unsigned>& Arguments, bool& Unknown) {
+    if (Root == NULL)
+        Unknown = true;
+    else if (GlobalVariable* G = dyn_cast<GlobalVariable>(Root))
+        Globals.push_back(G);
+    else if (Argument* A = dyn_cast<Argument>(Root))
+        Arguments.push_back(A->getArgNo());
+    else if (!isa<AllocaInst>(Root))
+        Unknown = true;
+}
+
+template <typename T>
+static void sortUnique(std::vector<T>& V) {
+    std::sort(V.begin(), V.end());
+    V.erase(std::unique(V.begin(), V.end()), V.end());
+}
+
+//===----------------------------------------------------------------------===//
+// ModRef Implementation
+//===----------------------------------------------------------------------===//
+
+// Summarize all functions of M, callees before callers
+//
+bool ModRef::runOnModule(Module& M) {
+    releaseMemory();
+    buildLevels(M);
+
+    for (unsigned I = 0, E = Levels.size(); I != E; ++I)
+    {
+        summarizeLevel(Levels[I]);
+    }
+
+    return false;
+}
+
+// Number the strongly connected components of the call graph bottom-up and
+// group them by height: a component only calls components of lower levels,
+// so the components of one level do not depend on each other
+//
+void ModRef::buildLevels(Module& M) {
+    CallGraph& CG = getAnalysis<CallGraph>();
+
+    DenseMap<const Function*, unsigned> SCCNumbers;
+    std::vector<unsigned> SCCLevels;
+
+    for (scc_iterator<CallGraph*> I = scc_begin(&CG), E = scc_end(&CG); I != E; ++I)
+    {
+        std::vector<CallGraphNode*>& Nodes = *I;
+        std::vector<Function*> Functions;
+
+        for (std::vector<CallGraphNode*>::iterator J = Nodes.begin(), JE = Nodes.end(); J != JE; ++J)
+        {
+            Function* F = (*J)->getFunction();
+            if (F != NULL && !F->isDeclaration())
+                Functions.push_back(F);
+        }
+
+        if (Functions.empty())
+            continue;
+
+        unsigned SCC = SCCs.size();
+        for (std::vector<Function*>::iterator J = Functions.begin(), JE = Functions.end(); J != JE; ++J)
+        {
+            SCCNumbers[*J] = SCC;
+            SummaryNumbers[*J] = Summaries.size();
+            Summaries.push_back(ModRefSummary());
+        }
+
+        // the callees are in components that were numbered before this one
+        unsigned Level = 0;
+        for (std::vector<Function*>::iterator J = Functions.begin(), JE = Functions.end(); J != JE; ++J)
+        {
+            CallGraphNode* Node = CG[*J];
+            for (CallGraphNode::iterator K = Node->begin(), KE = Node->end(); K != KE; ++K)
+            {
+                Function* Callee = K->second->getFunction();
+                if (Callee == NULL)
+                    continue;
+
+                DenseMap<const Function*, unsigned>::iterator Where = SCCNumbers.find(Callee);
+                if (Where != SCCNumbers.end() && Where->second != SCC)
+                    Level = std::max(Level, SCCLevels[Where->second] + 1);
+            }
+        }
+
+        SCCs.push_back(Functions);
+        SCCLevels.push_back(Level);
+
+        if (Levels.size() <= Level)
+            Levels.resize(Level + 1);
+        Levels[Level].push_back(SCC);
+    }
+}
+
+void* ModRef::runWorker(void* Arg) {
+    LevelWork* Work = static_cast<LevelWork*>(Arg);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&Work->Lock);
+        unsigned I = Work->Next++;
+        pthread_mutex_unlock(&Work->Lock);
+
+        if (I >= Work->SCCs->size())
+            break;
+
+        Work->Pass->summarizeSCC((*Work->SCCs)[I]);
+    }
+
+    return NULL;
+}
+
+// Summarize the components of one level in parallel. The threads only read
+// the IR and the summaries of lower levels, and each writes the summaries of
+// its own components
+//
+void ModRef::summarizeLevel(const std::vector<unsigned>& Level) {
+    unsigned NumThreads = ModRefThreads;
+    if (NumThreads == 0)
+    {
+        long NumProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        NumThreads = NumProcessors > 0 ? NumProcessors : 1;
+    }
+    NumThreads = std::min(NumThreads, (unsigned)Level.size());
+
+    LevelWork Work;
+    Work.Pass = this;
+    Work.SCCs = &Level;
+    Work.Next = 0;
+    pthread_mutex_init(&Work.Lock, NULL);
+
+    // the calling thread is one of the workers
+    std::vector<pthread_t> Threads;
+    for (unsigned I = 1; I < NumThreads; ++I)
+    {
+        pthread_t Thread;
+        if (pthread_create(&Thread, NULL, runWorker, &Work) != 0)
+            break;
+        Threads.push_back(Thread);
+    }
+
+    runWorker(&Work);
+
+    for (std::vector<pthread_t>::iterator I = Threads.begin(), E = Threads.end(); I != E; ++I)
+    {
+        pthread_join(*I, NULL);
+    }
+
+    pthread_mutex_destroy(&Work.Lock);
+}
+
+// The functions of a component may call each other, so they are summarized
+// until none of their summaries grows anymore. The pointer operands are
+// resolved once per component, not once per iteration
+//
+void ModRef::summarizeSCC(unsigned SCC) {
+    const std::vector<Function*>& Functions = SCCs[SCC];
+    CoreOperandCache Cache;
+    bool Changed;
+
+    do
+    {
+        Changed = false;
+
+        for (std::vector<Function*>::const_iterator I = Functions.begin(), E = Functions.end(); I != E; ++I)
+        {
+            ModRefSummary& Summary = Summaries[SummaryNumbers.find(*I)->second];
+            ModRefSummary NewSummary = Summary;
+            summarize(*I, NewSummary, Cache);
+
+            if (!(NewSummary == Summary))
+            {
+                Summary = NewSummary;
+                Changed = true;
+            }
+        }
+    } while (Changed);
+}
+
+// Add the memory F accesses directly and through its calls to Summary
+//
+void ModRef::summarize(Function* F, ModRefSummary& Summary, CoreOperandCache& Cache) const {
+    for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+    {
+        Instruction* Inst = &*I;
+
+        if (StoreInst* S = dyn_cast<StoreInst>(Inst))
+        {
+            addRoot(getRoot(S->getPointerOperand(), &Cache), Summary.ModGlobals, Summary.ModArguments, Summary.ModUnknown);
+        }
+        else if (LoadInst* L = dyn_cast<LoadInst>(Inst))
+        {
+            addRoot(getRoot(L->getPointerOperand(), &Cache), Summary.RefGlobals, Summary.RefArguments, Summary.RefUnknown);
+        }
+        else if (isa<CallInst>(Inst) || isa<InvokeInst>(Inst))
+        {
+            CallSite CS = CallSite::get(Inst);
+            CallEffects Effects;
+            getCallEffects(CS, Effects, &Cache);
+
+            for (SmallVector<Value*, 4>::iterator J = Effects.Mod.begin(), JE = Effects.Mod.end(); J != JE; ++J)
+                addRoot(*J, Summary.ModGlobals, Summary.ModArguments, Summary.ModUnknown);
+
+            for (SmallVector<Value*, 4>::iterator J = Effects.Ref.begin(), JE = Effects.Ref.end(); J != JE; ++J)
+                addRoot(*J, Summary.RefGlobals, Summary.RefArguments, Summary.RefUnknown);
+
+            Summary.ModUnknown |= Effects.ModUnknown;
+            Summary.RefUnknown |= Effects.RefUnknown;
+        }
+    }
+
+    sortUnique(Summary.ModGlobals);
+    sortUnique(Summary.RefGlobals);
+    sortUnique(Summary.ModArguments);
+    sortUnique(Summary.RefArguments);
+}
+
+// Translate the summary of the callee of CS to the memory of the caller
+//
+void ModRef::getCallEffects(CallSite CS, CallEffects& Effects, CoreOperandCache* Cache) const {
+    Function* Callee = CS.getCalledFunction();
+    if (Callee != NULL && Callee->doesNotAccessMemory())
+        return;
+
+    const ModRefSummary* Summary = Callee != NULL ? getSummary(Callee) : NULL;
+    if (Summary == NULL)
+    {
+        // nothing is known about the callee, it may access all the memory that
+        // escaped and all the memory that is passed to it
+        bool MayModify = Callee == NULL || !Callee->onlyReadsMemory();
+
+        for (CallSite::arg_iterator I = CS.arg_begin(), E = CS.arg_end(); I != E; ++I)
+        {
+            Value* Root = getRoot(*I, Cache);
+            if (Root == NULL)
+                continue;
+
+            if (MayModify)
+                Effects.Mod.push_back(Root);
+            Effects.Ref.push_back(Root);
+        }
+
+        Effects.ModUnknown = MayModify;
+        Effects.RefUnknown = true;
+        return;
+    }
+
+    Effects.Mod.append(Summary->ModGlobals.begin(), Summary->ModGlobals.end());
+    Effects.Ref.append(Summary->RefGlobals.begin(), Summary->RefGlobals.end());
+
+    for (std::vector<unsigned>::const_iterator I = Summary->ModArguments.begin(), E = Summary->ModArguments.end(); I != E; ++I)
+    {
+        Value* Root = *I < CS.arg_size() ? getRoot(CS.getArgument(*I), Cache) : NULL;
+        if (Root != NULL)
+            Effects.Mod.push_back(Root);
+        else
+            Effects.ModUnknown = true;
+    }
+
+    for (std::vector<unsigned>::const_iterator I = Summary->RefArguments.begin(), E = Summary->RefArguments.end(); I != E; ++I)
+    {
+        Value* Root = *I < CS.arg_size() ? getRoot(CS.getArgument(*I), Cache) : NULL;
+        if (Root != NULL)
+            Effects.Ref.push_back(Root);
+        else
+            Effects.RefUnknown = true;
+    }
+
+    Effects.ModUnknown |= Summary->ModUnknown;
+    Effects.RefUnknown |= Summary->RefUnknown;
+}
+
+void ModRef::releaseMemory() {
+    SummaryNumbers.clear();
+    Summaries.clear();
+    SCCs.clear();
+    Levels.clear();
+}
+
+void ModRef::getAnalysisUsage(AnalysisUsage& AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<CallGraph>();
+}
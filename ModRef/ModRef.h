@@ -0,0 +1,114 @@
+//===- ModRef.h - ModRef class definition -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the declaration of the ModRef class, which computes
+// which memory every function of a module may modify and read.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_MODREF_H
+#define LLVM_MODREF_H
+
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "../CoreOperandCache.h"
+#include <vector>
+
+namespace llvm {
+
+// The memory a function may modify and read, in terms of its callers: the
+// globals it accesses and the numbers of the pointer arguments whose memory
+// it accesses. Anything that cannot be attributed to one of those, like heap
+// memory reached through a returned pointer, sets the unknown flag
+//
+struct ModRefSummary {
+    ModRefSummary() : ModUnknown(false), RefUnknown(false) {}
+
+    std::vector<GlobalVariable*> ModGlobals;   // sorted
+    std::vector<GlobalVariable*> RefGlobals;   // sorted
+    std::vector<unsigned> ModArguments;        // sorted
+    std::vector<unsigned> RefArguments;        // sorted
+    bool ModUnknown;
+    bool RefUnknown;
+
+    bool operator==(const ModRefSummary& O) const {
+        return ModUnknown == O.ModUnknown && RefUnknown == O.RefUnknown &&
+               ModGlobals == O.ModGlobals && RefGlobals == O.RefGlobals &&
+               ModArguments == O.ModArguments && RefArguments == O.RefArguments;
+    }
+};
+
+// The effect of one call site, in terms of the caller. Mod and Ref hold the
+// core operands (see findCoreOperand) the call may write and read: globals,
+// arguments and allocas of the caller. The unknown flags mean the call may
+// also access any memory that escaped, i.e. every global and argument
+//
+struct CallEffects {
+    CallEffects() : ModUnknown(false), RefUnknown(false) {}
+
+    SmallVector<Value*, 4> Mod;
+    SmallVector<Value*, 4> Ref;
+    bool ModUnknown;
+    bool RefUnknown;
+
+    bool empty() const { return Mod.empty() && Ref.empty() && !ModUnknown && !RefUnknown; }
+};
+
+//===----------------------------------------------------------------------===//
+//
+// ModRef class - This class computes a ModRefSummary for every function with
+//    a body. The call graph is walked bottom-up, one strongly connected
+//    component at a time; the components that do not call each other are
+//    summarized in parallel
+//
+class ModRef : public ModulePass {
+    DenseMap<const Function*, unsigned> SummaryNumbers;
+    std::vector<ModRefSummary> Summaries;
+
+    // the strongly connected components of the call graph, bottom-up, and the
+    // components grouped by their height in the condensed call graph
+    std::vector<std::vector<Function*> > SCCs;
+    std::vector<std::vector<unsigned> > Levels;
+
+    public:
+        static char ID;
+        ModRef() : ModulePass(&ID) {}
+
+        virtual bool runOnModule(Module& M);
+
+        virtual void getAnalysisUsage(AnalysisUsage& AU) const;
+
+        virtual void releaseMemory();
+
+        // return the summary of F or NULL if F has no body
+        const ModRefSummary* getSummary(const Function* F) const {
+            DenseMap<const Function*, unsigned>::const_iterator I = SummaryNumbers.find(F);
+            return I != SummaryNumbers.end() ? &Summaries[I->second] : NULL;
+        }
+
+        // the memory the call CS may modify and read. The pointer arguments are
+        // resolved through Cache if one is given
+        void getCallEffects(CallSite CS, CallEffects& Effects, CoreOperandCache* Cache = NULL) const;
+
+    private:
+        void buildLevels(Module& M);
+        void summarizeLevel(const std::vector<unsigned>& Level);
+        void summarizeSCC(unsigned SCC);
+        void summarize(Function* F, ModRefSummary& Summary, CoreOperandCache& Cache) const;
+
+        static void* runWorker(void* Arg);
+};
+
+} //End llvm namespace
+
+#endif // LLVM_MODREF_H
@@ -0,0 +1,69 @@
+#include "ProfileData.h"
+#include <fstream>
+#include <sstream>
+
+using namespace llvm;
+
+bool ProfileData::load(const std::string& filename, std::string& error)
+{
+    std::ifstream file(filename.c_str());
+    if (!file)
+    {
+        error = "can not open profile " + filename;
+        return false;
+    }
+
+    std::string line;
+    for (unsigned int lineNumber = 1; std::getline(file, line); ++lineNumber)
+    {
+        std::istringstream fields(line);
+        std::string field[3];
+        unsigned int numFields = 0;
+
+        while (numFields < 3 && fields >> field[numFields])
+        {
+            ++numFields;
+        }
+
+        if (numFields == 0 || field[0][0] == '#') continue;
+
+        std::string extra;
+        std::istringstream count(field[numFields - 1]);
+        uint64_t value;
+
+        if (numFields < 2 || fields >> extra || !(count >> value) || !count.eof())
+        {
+            std::ostringstream message;
+            message << filename << ":" << lineNumber << ": expected 'function count' or 'function header count'";
+            error = message.str();
+            return false;
+        }
+
+        if (numFields == 2)
+        {
+            m_functionCounts[field[0]] = value;
+        }
+        else
+        {
+            m_loopCounts[getKey(field[0], field[1])] = value;
+        }
+    }
+
+    m_isLoaded = true;
+    return true;
+}
+
+uint64_t ProfileData::getCount(const Function& function) const
+{
+    StringMap<uint64_t>::const_iterator where = m_functionCounts.find(function.getName());
+    return where != m_functionCounts.end() ? where->second : 0;
+}
+
+uint64_t ProfileData::getCount(Loop* loop) const
+{
+    BasicBlock* header = loop->getHeader();
+    const Function& function = *header->getParent();
+
+    StringMap<uint64_t>::const_iterator where = m_loopCounts.find(getKey(function.getName().str(), header->getName().str()));
+    return where != m_loopCounts.end() ? where->second : getCount(function);
+}
@@ -0,0 +1,46 @@
+#include "llvm/Function.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/System/DataTypes.h"
+#include <string>
+
+using namespace llvm;
+
+#ifndef PROFILEDATA_H
+#define PROFILEDATA_H
+
+//execution counts of functions and loops read from a profile file. Every line is
+//either "function count" or "function header count", where header is the name of the
+//header block of a loop. Empty lines and lines starting with # are ignored
+class ProfileData
+{
+    public:
+
+        ProfileData() : m_isLoaded(false) {}
+
+        //return false and describe the problem in error if filename can not be read
+        //or has a malformed line
+        bool load(const std::string& filename, std::string& error);
+
+        bool isLoaded(void) const { return m_isLoaded; }
+
+        //return the count of function or 0 if it is not in the profile
+        uint64_t getCount(const Function& function) const;
+
+        //return the count of loop. A loop that is not in the profile gets the count of
+        //its function, so that loops of hot functions still come before cold ones
+        uint64_t getCount(Loop* loop) const;
+
+    private:
+        static std::string getKey(const std::string& function, const std::string& header)
+        {
+            return function + " " + header;
+        }
+
+    private:
+        bool m_isLoaded;
+        StringMap<uint64_t> m_functionCounts;
+        StringMap<uint64_t> m_loopCounts; //keyed by getKey
+};
+
+#endif //PROFILEDATA_H
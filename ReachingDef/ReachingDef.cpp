@@ -29,181 +29,249 @@ char ReachingDef::ID;
 static RegisterPass<ReachingDef> 
 C("reaching-def", "compute reaching definitions for structures and arrays");
 
-void BasicBlockDup::addToKillSet(std::vector<Instruction*>& killed)
-{
-    m_killSet.insert(killed.begin(), killed.end());
-}
-
 //===----------------------------------------------------------------------===//
 // ReachingDef Implementation
 //===----------------------------------------------------------------------===//
         
 ReachingDef::ReachingDef() 
     :   FunctionPass(&ID), 
+        m_numStores(0),
         m_previousFunction(NULL), 
-        m_currentFunction(NULL)
-        //m_udChain(NULL)
+        m_currentFunction(NULL),
+        m_isComputed(false),
+        m_numbering(NULL),
+        m_modRef(NULL)
 {}
 
-ReachingDef::~ReachingDef(void)
+void ReachingDef::clear()
+{
+    m_assignmentMap.clear();
+    m_killMap.clear();
+    m_lastWriteMap.clear();
+    m_basicBlockDups.clear();
+    m_udChain.clear();
+    m_definitions.clear();
+    m_coreOperands.clear();
+}
+
+//size the per block sets and the definition masks for the current index
+void ReachingDef::initializeSets(void)
 {
-    for (BasicBlockDupMapType::iterator i = m_basicBlockDupMap.begin(); i != m_basicBlockDupMap.end(); ++i)
+    m_numStores = m_numbering->getNumStores();
+    unsigned numDefinitions = getNumDefinitions();
+
+    m_basicBlockDups.resize(m_numbering->getNumBlocks(), BasicBlockDup(numDefinitions));
+
+    m_unknownDefinitions.clear();
+    m_unknownDefinitions.resize(numDefinitions);
+}
+
+Instruction* ReachingDef::getDefinition(unsigned definition) const
+{
+    if (definition < m_numStores)
     {
-        free((*i).second);
+        return m_numbering->getStore(definition);
     }
+
+    return m_instructionIndex.getCall(definition - m_numStores).call;
 }
 
 void ReachingDef::findDownwardsExposed(BasicBlock* block)
 {
-    BasicBlockDup* currentDup = new BasicBlockDup(block);
-    m_basicBlockDupMap.insert(BasicBlockDupMapElementType(block, currentDup));
-                
-    DownwardsExposedMapType& currentDownwardsExposedMap = currentDup->getDownwardsExposedMap();
-    LastWriteMapType& currentLastWriteMap = currentDup->getLastWriteMap();
+    unsigned numDefinitions = getNumDefinitions();
+    BasicBlockDup& currentDup = m_basicBlockDups[m_numbering->getBlockNumber(block)];
+
+    m_lastWriteMap.clear();
  
-    for (BasicBlock::iterator i = block->begin(); i != block->end(); ++i)
+    Span<InstructionIndex::StoreEntry> stores = m_instructionIndex.getStores(block);
+    for (Span<InstructionIndex::StoreEntry>::iterator i = stores.begin(); i != stores.end(); ++i)
     {
-        Instruction& inst = *i;
+        unsigned storeNumber = m_numbering->getStoreNumber(i->store);
+        Value* coreOperand = i->coreOperand;
+        const Type* coreOperandType = i->coreOperandType;
 
-        if (StoreInst* storeInst = dyn_cast<StoreInst>(&inst))
+        if (coreOperand == NULL) continue;
+
+        BitVector& assignments = m_assignmentMap[coreOperand];
+        if (assignments.empty())
         {
-            Value* coreOperand;
-            const Type* coreOperandType = NULL;
-        
-            findCoreOperand(storeInst->getPointerOperand(), &coreOperand, &coreOperandType);
-            if (coreOperand == NULL) continue;
+            assignments.resize(numDefinitions);
+        }
+        assignments.set(storeNumber);
 
-            Type::TypeID typeID = coreOperandType->getTypeID();
+        Type::TypeID typeID = coreOperandType->getTypeID();
 
-            if (typeID != Type::StructTyID && typeID != Type::ArrayTyID)
+        if (typeID != Type::StructTyID && typeID != Type::ArrayTyID)
+        {
+            BitVector& kills = m_killMap[coreOperand];
+            if (kills.empty())
             {
-                AssignmentMapType::iterator where = m_assignmentMap.find(coreOperand);
-                if (where != m_assignmentMap.end())
-                {
-                    std::vector<Instruction*>& killed = m_assignmentMap[coreOperand];
-                    for (std::vector<Instruction*>::iterator j = killed.begin(); j != killed.end(); ++j)
-                    {
-                        //TODO: killed map can be maintained as a vector of sets, each value in a set kills all other values
-                        //search becomes harder though
-                        m_killedMap[*j].push_back(storeInst);
-                        m_killedMap[storeInst].push_back(*j);
-                    }
-                    //std::cout << "may be killed " << *storeInst << std::endl;
-                }
-                
-                m_assignmentMap[coreOperand].push_back(storeInst);
-
-                LastWriteMapType::iterator where2 = currentLastWriteMap.find(coreOperand);
-                if (where2 != currentLastWriteMap.end())
-                {
-                    //set the last instruction that was in the last write map to be not downwards exposed
-                    currentDownwardsExposedMap[currentLastWriteMap[coreOperand]] = false;
-                    //std::cout << "not downwards " << *currentLastWriteMap[coreOperand] << std::endl;
-                }
-
-                currentLastWriteMap[coreOperand] = storeInst;
+                kills.resize(numDefinitions);
             }
+            kills.set(storeNumber);
 
-            currentDownwardsExposedMap[storeInst] = true; //downwards exposed until we find the next write for coreOperand
+            LastWriteMapType::iterator where = m_lastWriteMap.find(coreOperand);
+            if (where != m_lastWriteMap.end())
+            {
+                //the last write to coreOperand in this block is not downwards exposed anymore
+                currentDup.removeFromGenSet(where->second);
+            }
+
+            m_lastWriteMap[coreOperand] = storeNumber;
         }
-    }
-}
 
-void ReachingDef::constructGenSet(BasicBlock* block)
-{
-    BasicBlockDup* basicBlockDup = m_basicBlockDupMap[block];
-    assert(basicBlockDup != NULL && "no match for a duplicate basic block!");
+        currentDup.addToGenSet(storeNumber); //downwards exposed until we find the next write for coreOperand
+    }
 
-    DownwardsExposedMapType& downwardsExposedMap = basicBlockDup->getDownwardsExposedMap();
-    
-    for (BasicBlock::iterator i = block->begin(); i != block->end(); ++i)
+    //calls are never killed, so they are always downwards exposed
+    Span<InstructionIndex::CallEntry> calls = m_instructionIndex.getCalls(block);
+    for (Span<InstructionIndex::CallEntry>::iterator i = calls.begin(); i != calls.end(); ++i)
     {
-        Instruction& inst = *i;
-        DownwardsExposedMapType::iterator where = downwardsExposedMap.find(&inst);
+        Span<Value*> modRoots = m_instructionIndex.getModRoots(*i);
+        if (modRoots.empty() && !i->modUnknown) continue;
+
+        unsigned definition = m_numStores + m_instructionIndex.getCallNumber(*i);
 
-        if (where != downwardsExposedMap.end())
+        for (Span<Value*>::iterator j = modRoots.begin(); j != modRoots.end(); ++j)
         {
-            if (where->second)
+            BitVector& assignments = m_assignmentMap[*j];
+            if (assignments.empty())
             {
-                basicBlockDup->addToGenSet(&inst);
-                //std::cout << "gen: " << inst << std::endl;
+                assignments.resize(numDefinitions);
             }
+            assignments.set(definition);
+        }
+
+        if (i->modUnknown)
+        {
+            m_unknownDefinitions.set(definition);
         }
+
+        currentDup.addToGenSet(definition);
     }
 }
 
+//a scalar store kills the other scalar stores to the same core operand that
+//findDownwardsExposed has seen so far, so it must run right after the block was
+//passed to findDownwardsExposed. Stores in blocks later in layout order are not
+//killed; this is how the kill sets have always been built and the verdicts depend
+//on it. Stores to arrays and structures are never killed
 void ReachingDef::constructKillSet(BasicBlock* block)
 {
-    BasicBlockDup* basicBlockDup = m_basicBlockDupMap[block];
-    assert(basicBlockDup != NULL && "no match for a duplicate basic block!");
+    BasicBlockDup& basicBlockDup = m_basicBlockDups[m_numbering->getBlockNumber(block)];
 
-    for (BasicBlock::iterator i = block->begin(); i != block->end(); ++i)
+    //only stores can be killed
+    Span<InstructionIndex::StoreEntry> stores = m_instructionIndex.getStores(block);
+    for (Span<InstructionIndex::StoreEntry>::iterator i = stores.begin(); i != stores.end(); ++i)
     {
-        Instruction& inst = *i;
+        if (i->coreOperand == NULL) continue;
 
-        KilledMapType::iterator where = m_killedMap.find(&inst);
-        if (where != m_killedMap.end())
+        Type::TypeID typeID = i->coreOperandType->getTypeID();
+        if (typeID != Type::StructTyID && typeID != Type::ArrayTyID)
         {
-            basicBlockDup->addToKillSet(where->second);
+            basicBlockDup.addToKillSet(m_killMap[i->coreOperand]);
         }
     }
 }
 
 void ReachingDef::constructInSets(Function& function)
+{
+    constructInSets(function, BitVector(m_numbering->getNumBlocks(), true));
+}
+
+//solve the in and out sets of blocks, the sets of all other blocks are taken as they are
+void ReachingDef::constructInSets(Function& function, const BitVector& blocks)
 {
     bool hasChanged;
     int iter = 0;
         
-    BasicBlockDup* entryDup = m_basicBlockDupMap[&function.getEntryBlock()];
-    entryDup->setInSet(entryDup->getGenSet());
+    unsigned entryNumber = m_numbering->getBlockNumber(&function.getEntryBlock());
+    if (blocks.test(entryNumber))
+    {
+        BasicBlockDup& entryDup = m_basicBlockDups[entryNumber];
+        entryDup.setInSet(entryDup.getGenSet());
+    }
+
+    OutSetType outSet;
     
     do
     {
         hasChanged = false;
 
-        for (Function::iterator i = function.begin(); i != function.end(); ++i)
+        for (int n = blocks.find_first(); n != -1; n = blocks.find_next(n))
         {
-            BasicBlock* block = &*i;
+            BasicBlock* block = m_numbering->getBlock(n);
  
-            //std::cout << block->getNameStr() << std::endl;
-            BasicBlockDup* dup = m_basicBlockDupMap[block];
-            InSetType& inSet = dup->getInSet();
+            BasicBlockDup& dup = m_basicBlockDups[n];
+            InSetType& inSet = dup.getInSet();
             for (pred_iterator j = pred_begin(block); j != pred_end(block); ++j)
             {
-                BasicBlockDup* predDup = m_basicBlockDupMap[*j];
-                OutSetType& outSet = predDup->getOutSet();
-                inSet.insert(outSet.begin(), outSet.end());
+                inSet |= m_basicBlockDups[m_numbering->getBlockNumber(*j)].getOutSet();
             }
 
-            KillSetType& killSet = dup->getKillSet();
-            InSetType tempSet;
-
-            std::set_difference(inSet.begin(), inSet.end(), killSet.begin(), killSet.end(), inserter(tempSet, tempSet.begin()));
+            //out = gen U (in - kill)
+            outSet = dup.getKillSet();
+            outSet.flip();
+            outSet &= inSet;
+            outSet |= dup.getGenSet();
+            outSet |= dup.getOutSet();
 
-            OutSetType& outSet = dup->getOutSet();
-            size_t oldOutSetSize = outSet.size();
-
-            GenSetType& genSet = dup->getGenSet();
-            
-            std::set_union(genSet.begin(), genSet.end(), tempSet.begin(), tempSet.end(), inserter(outSet, outSet.begin()));
-            
-            if (outSet.size() != oldOutSetSize)
+            if (outSet != dup.getOutSet())
             {
+                dup.getOutSet() = outSet;
                 hasChanged = true;
             }
         }
 
-        //std::cout << iter << std::endl;
         ++iter;
     } while (hasChanged);
 }
 
-void ReachingDef::findDefinitions(BasicBlockDup* blockDup, LoadInst* loadInst)
+//translate a set over the old definitions to the new ones, definitions that are gone
+//are dropped. callRemap gives the new definition of every old call
+void ReachingDef::remapSet(const BitVector& oldSet, BitVector& newSet, unsigned oldNumStores, const std::vector<unsigned>& callRemap) const
+{
+    for (int i = oldSet.find_first(); i != -1; i = oldSet.find_next(i))
+    {
+        unsigned definition = (unsigned)i < oldNumStores ? m_numbering->getNewStoreNumber(i) : callRemap[i - oldNumStores];
+        if (definition != ValueNumbering::Unnumbered)
+        {
+            newSet.set(definition);
+        }
+    }
+}
+
+//add the stores and calls that may write to coreOperand. Calls with unknown effects
+//may write every global and every argument
+void ReachingDef::addDefinitionsOf(Value* coreOperand, BitVector& definitions) const
+{
+    AssignmentMapType::const_iterator where = m_assignmentMap.find(coreOperand);
+    if (where != m_assignmentMap.end())
+    {
+        definitions |= where->second;
+    }
+
+    if (isa<GlobalVariable>(coreOperand) || isa<Argument>(coreOperand))
+    {
+        definitions |= m_unknownDefinitions;
+    }
+}
+
+void ReachingDef::addUDChain(Instruction* user, BitVector& reaching)
+{
+    BufferRange& range = m_udChain[m_numbering->getInstructionNumber(user)];
+    for (int i = reaching.find_first(); i != -1; i = reaching.find_next(i))
+    {
+        appendToRange(m_definitions, range, getDefinition(i));
+    }
+}
+
+void ReachingDef::findDefinitions(BasicBlockDup& blockDup, const InstructionIndex::LoadEntry& load)
 {
-    InSetType& inSet = blockDup->getInSet();
+    InSetType& inSet = blockDup.getInSet();
 
-    Value* loadCoreOperand = NULL;
-    findCoreOperand(loadInst->getPointerOperand(), &loadCoreOperand);
+    LoadInst* loadInst = load.load;
+    Value* loadCoreOperand = load.coreOperand;
     
     //TODO: this check should be removed
     if (loadCoreOperand == NULL)
@@ -212,75 +280,244 @@ void ReachingDef::findDefinitions(BasicBlockDup* blockDup, LoadInst* loadInst)
     }
     assert(loadCoreOperand != NULL);
 
-    for (InSetType::iterator i = inSet.begin(); i != inSet.end(); ++i)
+    BitVector reaching(getNumDefinitions());
+    addDefinitionsOf(loadCoreOperand, reaching);
+    reaching &= inSet;
+
+    addUDChain(loadInst, reaching);
+}
+
+//a call that may read memory is a use of everything its summary says it reads
+void ReachingDef::findDefinitions(BasicBlockDup& blockDup, const InstructionIndex::CallEntry& call)
+{
+    InSetType& inSet = blockDup.getInSet();
+    BitVector reaching(getNumDefinitions());
+
+    if (call.refUnknown)
     {
-        StoreInst *storeInst = dyn_cast<StoreInst>(*i);
-        assert(storeInst != NULL && "not a store instruction!");
-        
-        Value* storeCoreOperand = NULL;
-        findCoreOperand(storeInst->getPointerOperand(), &storeCoreOperand);
+        reaching = inSet;
+    }
+    else
+    {
+        Span<Value*> refRoots = m_instructionIndex.getRefRoots(call);
+        if (refRoots.empty()) return;
 
-        if (loadCoreOperand == storeCoreOperand)
+        for (Span<Value*>::iterator i = refRoots.begin(); i != refRoots.end(); ++i)
         {
-            m_udChain[loadInst].push_back(storeInst);
+            addDefinitionsOf(*i, reaching);
         }
+        reaching &= inSet;
     }
+
+    addUDChain(call.call, reaching);
 }
 
 void ReachingDef::constructUDChain(Function& function)
 {
-    for (inst_iterator i = inst_begin(function); i != inst_end(function); ++i)
+    m_udChain.resize(m_numbering->getNumInstructions());
+
+    for (Function::iterator i = function.begin(); i != function.end(); ++i)
     {
-        Instruction& inst = *i;
-        if (LoadInst *loadInst = dyn_cast<LoadInst>(&inst))
+        Span<InstructionIndex::LoadEntry> loads = m_instructionIndex.getLoads(i);
+        Span<InstructionIndex::CallEntry> calls = m_instructionIndex.getCalls(i);
+        if (loads.empty() && calls.empty()) continue;
+
+        BasicBlockDup& blockDup = m_basicBlockDups[m_numbering->getBlockNumber(i)];
+        for (Span<InstructionIndex::LoadEntry>::iterator j = loads.begin(); j != loads.end(); ++j)
+        {
+            findDefinitions(blockDup, *j);
+        }
+
+        for (Span<InstructionIndex::CallEntry>::iterator j = calls.begin(); j != calls.end(); ++j)
         {
-            BasicBlockDup* blockDup = m_basicBlockDupMap[inst.getParent()];
-            
-            findDefinitions(blockDup, loadInst);
+            findDefinitions(blockDup, *j);
         }
     }
 }
 
-// Compute reaching definitions for arrays in all basic blocks of this function
-//
 bool ReachingDef::runOnFunction(Function& function)
 {
+    setFunction(function, getAnalysis<ValueNumbering>(), getAnalysis<ModRef>());
+    return false;
+}
+
+void ReachingDef::setFunction(Function& function, const ValueNumbering& numbering, const ModRef& modRef)
+{
+    clear();
+
     m_currentFunction = &function;
+    m_isComputed = false;
+    m_numbering = &numbering;
+    m_modRef = &modRef;
+}
+
+// Compute reaching definitions for arrays in all basic blocks of this function
+//
+void ReachingDef::compute(void)
+{
+    assert(m_currentFunction != NULL && "compute called before runOnFunction");
+    if (m_isComputed) return;
+
+    Function& function = *m_currentFunction;
+    m_instructionIndex.build(function, *m_numbering, *m_modRef, m_coreOperands);
+
+    initializeSets();
+
     for (Function::iterator i = function.begin(); i != function.end(); ++i)
     {
-        BasicBlock& block = *i;
-        
-        findDownwardsExposed(&block);
-        constructGenSet(&block);
-        constructKillSet(&block);
+        findDownwardsExposed(i);
+        constructKillSet(i);
     }
 
     constructInSets(function);
     constructUDChain(function);
 //    printa();
 
-    return false;
+    m_isComputed = true;
+}
+
+//a block that is not reachable from a changed block only sees definitions that are
+//not reachable from one either, so its sets stay the same. Those sets only mention
+//stores and calls outside the changed blocks, which still exist and can be renumbered
+void ReachingDef::update(Function& function, const std::vector<BasicBlock*>& changedBlocks, BitVector& affectedBlocks)
+{
+    assert(m_currentFunction == &function && m_isComputed);
+
+    unsigned numBlocks = m_numbering->getNumBlocks();
+    assert(affectedBlocks.size() == numBlocks && "affectedBlocks must be over the new block numbers");
+
+    BitVector reachable(numBlocks);
+    std::vector<BasicBlock*> worklist(changedBlocks);
+    for (std::vector<BasicBlock*>::iterator i = worklist.begin(); i != worklist.end(); ++i)
+    {
+        reachable.set(m_numbering->getBlockNumber(*i));
+    }
+
+    while (!worklist.empty())
+    {
+        BasicBlock* block = worklist.back();
+        worklist.pop_back();
+
+        for (succ_iterator i = succ_begin(block); i != succ_end(block); ++i)
+        {
+            unsigned number = m_numbering->getBlockNumber(*i);
+            if (!reachable.test(number))
+            {
+                reachable.set(number);
+                worklist.push_back(*i);
+            }
+        }
+    }
+
+    std::vector<BasicBlockDup> oldDups;
+    oldDups.swap(m_basicBlockDups);
+
+    unsigned oldNumStores = m_numStores;
+    std::vector<Instruction*> oldCalls;
+    for (unsigned i = 0; i < m_instructionIndex.getNumCalls(); ++i)
+    {
+        oldCalls.push_back(m_instructionIndex.getCall(i).call);
+    }
+
+    //values may have been deleted and their addresses reused, so nothing resolved
+    //before the transformation can be trusted
+    m_assignmentMap.clear();
+    m_killMap.clear();
+    m_udChain.clear();
+    m_definitions.clear();
+    m_coreOperands.clear();
+    m_instructionIndex.build(function, *m_numbering, *m_modRef, m_coreOperands);
+    initializeSets();
+
+    unsigned numDefinitions = getNumDefinitions();
+
+    //calls have no number of their own in the ValueNumbering, so they are matched by address
+    DenseMap<Instruction*, unsigned> callDefinitions;
+    for (unsigned i = 0; i < m_instructionIndex.getNumCalls(); ++i)
+    {
+        callDefinitions[m_instructionIndex.getCall(i).call] = m_numStores + i;
+    }
+
+    std::vector<unsigned> callRemap(oldCalls.size(), ValueNumbering::Unnumbered);
+    for (unsigned i = 0; i < oldCalls.size(); ++i)
+    {
+        DenseMap<Instruction*, unsigned>::iterator where = callDefinitions.find(oldCalls[i]);
+        if (where != callDefinitions.end())
+        {
+            callRemap[i] = where->second;
+        }
+    }
+
+    //the in sets from before, to find the blocks whose in set changed
+    std::vector<InSetType> oldInSets(numBlocks);
+    for (unsigned i = 0; i < oldDups.size(); ++i)
+    {
+        unsigned number = m_numbering->getNewBlockNumber(i);
+        if (number == ValueNumbering::Unnumbered) continue;
+
+        BasicBlockDup& dup = m_basicBlockDups[number];
+        if (reachable.test(number))
+        {
+            oldInSets[number].resize(numDefinitions);
+            remapSet(oldDups[i].getInSet(), oldInSets[number], oldNumStores, callRemap);
+        }
+        else
+        {
+            remapSet(oldDups[i].getInSet(), dup.getInSet(), oldNumStores, callRemap);
+            remapSet(oldDups[i].getOutSet(), dup.getOutSet(), oldNumStores, callRemap);
+        }
+    }
+    oldDups.clear();
+
+    //the assignment map needs the stores of every block, the kill sets are only
+    //needed where the sets are solved again
+    for (Function::iterator i = function.begin(); i != function.end(); ++i)
+    {
+        findDownwardsExposed(i);
+        if (reachable.test(m_numbering->getBlockNumber(i)))
+        {
+            constructKillSet(i);
+        }
+    }
+
+    constructInSets(function, reachable);
+    constructUDChain(function);
+
+    for (std::vector<BasicBlock*>::const_iterator i = changedBlocks.begin(); i != changedBlocks.end(); ++i)
+    {
+        affectedBlocks.set(m_numbering->getBlockNumber(*i));
+    }
+
+    for (int n = reachable.find_first(); n != -1; n = reachable.find_next(n))
+    {
+        //new blocks have an empty old in set
+        if (oldInSets[n].empty() || oldInSets[n] != m_basicBlockDups[n].getInSet())
+        {
+            affectedBlocks.set(n);
+        }
+    }
 }
 
-std::vector<StoreInst*>& ReachingDef::getDefinitions(LoadInst* loadInst)
+Span<Instruction*> ReachingDef::getDefinitions(Instruction* user) const
 {
-    assert(m_currentFunction != NULL); 
+    assert(m_currentFunction != NULL && m_isComputed);
     
-    return m_udChain[loadInst];
+    return makeSpan(m_definitions, m_udChain[m_numbering->getInstructionNumber(user)]);
 }
 
 void ReachingDef::printa(void)
 {
-    for (UDChainMapType::iterator i = m_udChain.begin(); i != m_udChain.end(); ++i)
+    for (Function::iterator i = m_currentFunction->begin(); i != m_currentFunction->end(); ++i)
     {
-        Value* coreOperand;
-        findCoreOperand(i->first->getPointerOperand(), &coreOperand);
-
-        //std::cout << "For load from " << (*coreOperand).getName().str() << " in " << *i->first << std::endl;
-        std::vector<StoreInst*>& rd = i->second;
-        for (std::vector<StoreInst*>::iterator j = rd.begin(); j != rd.end(); ++j)
+        Span<InstructionIndex::LoadEntry> loads = m_instructionIndex.getLoads(i);
+        for (Span<InstructionIndex::LoadEntry>::iterator j = loads.begin(); j != loads.end(); ++j)
         {
-            //std::cout << "\t" << **j << std::endl;
+            //std::cout << "For load from " << (*j->coreOperand).getName().str() << " in " << *j->load << std::endl;
+            Span<Instruction*> rd = getDefinitions(j->load);
+            for (Span<Instruction*>::iterator k = rd.begin(); k != rd.end(); ++k)
+            {
+                //std::cout << "\t" << **k << std::endl;
+            }
         }
     }
 }
@@ -288,5 +525,6 @@ void ReachingDef::printa(void)
 void ReachingDef::getAnalysisUsage(AnalysisUsage& AU) const
 {
     AU.setPreservesAll();
+    AU.addRequired<ValueNumbering>();
+    AU.addRequired<ModRef>();
 }
-
@@ -17,35 +17,39 @@
 
 //#include "llvm/Pass.h"
 //#include "llvm/BasicBlock.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include <vector>
-#include <map>
+#include "../InstructionIndex.h"
+#include "../ValueNumbering/ValueNumbering.h"
+#include "../ModRef/ModRef.h"
 
 namespace llvm
 {
 
-typedef std::pair<Instruction*, bool> DownwardsExposedElementType;
-typedef std::map<Instruction*, bool> DownwardsExposedMapType;
-
-typedef std::pair<Value*, Instruction*> LastWriteElementType;
-typedef std::map<Value*, Instruction*> LastWriteMapType;
-
-typedef std::set<Instruction*> GenSetType;
-typedef std::set<Instruction*> KillSetType;
-typedef std::set<Instruction*> InSetType;
-typedef std::set<Instruction*> OutSetType;
+// the sets are bit vectors over the definitions of the function: the stores, by
+// their store number, followed by the calls that may write memory, by their
+// number in the InstructionIndex
+typedef BitVector GenSetType;
+typedef BitVector KillSetType;
+typedef BitVector InSetType;
+typedef BitVector OutSetType;
 
 class BasicBlockDup
 {
     public:
-        BasicBlockDup(BasicBlock* originalBlock) : m_originalBlock(originalBlock) {}
+        BasicBlockDup(unsigned numDefinitions) 
+            :   m_genSet(numDefinitions), 
+                m_killSet(numDefinitions), 
+                m_inSet(numDefinitions), 
+                m_outSet(numDefinitions) 
+        {}
     
-        DownwardsExposedMapType& getDownwardsExposedMap(void) { return m_downwardsExposedMap; }
-        LastWriteMapType& getLastWriteMap(void) { return m_lastWriteMap; }
-
-        void addToGenSet(Instruction* inst) { m_genSet.insert(inst); }
+        void addToGenSet(unsigned definition) { m_genSet.set(definition); }
+        void removeFromGenSet(unsigned definition) { m_genSet.reset(definition); }
         GenSetType& getGenSet(void) { return m_genSet; }
  
-        void addToKillSet(std::vector<Instruction*>& killed);
+        void addToKillSet(const BitVector& killed) { m_killSet |= killed; }
         KillSetType& getKillSet(void) { return m_killSet; }
 
         InSetType& getInSet(void) { return m_inSet; }
@@ -53,10 +57,6 @@ class BasicBlockDup
         OutSetType& getOutSet(void) { return m_outSet; }
 
     private:
-        
-        BasicBlock* m_originalBlock;
-        DownwardsExposedMapType m_downwardsExposedMap;
-        LastWriteMapType m_lastWriteMap;
         GenSetType m_genSet;
         KillSetType m_killSet;
 
@@ -68,45 +68,76 @@ class BasicBlockDup
 //
 // ReachingDef class - This class computes the reaching definitions for arrays 
 //    by treating the defintion of any element of an array as a definition
-//    of the array
+//    of the array. A call is a definition of everything its ModRef summary
+//    says it may write; calls never kill a definition
 //
 class ReachingDef : public FunctionPass
 {
-    // type for representing control dependents - if a is control dependent on b
-    // then a will be in the vector for b
-    //
-    typedef std::map<Instruction*, std::vector<Instruction*> > KilledMapType;
-    typedef std::map<Value*, std::vector<Instruction*> > AssignmentMapType;
-    typedef std::map<BasicBlock*, BasicBlockDup*> BasicBlockDupMapType;
-    typedef std::pair<BasicBlock*, BasicBlockDup*> BasicBlockDupMapElementType;
-    typedef std::pair<LoadInst*, std::vector<StoreInst*> > UDChainMapElementType;
-    typedef std::map<LoadInst*, std::vector<StoreInst*> > UDChainMapType;
-
-    //typedef std::map<Function*, UDChainMapType* > FunctionUDChainMapType;
-    //typedef std::pair<Function*, UDChainMapType* > FunctionUDChainMapElementType;
+    // for every core operand, the stores and calls that write to it
+    typedef DenseMap<Value*, BitVector> AssignmentMapType;
+    typedef DenseMap<Value*, unsigned> LastWriteMapType;
 
     AssignmentMapType m_assignmentMap;
-    KilledMapType m_killedMap;
-    BasicBlockDupMapType m_basicBlockDupMap;
+    // for every core operand, the scalar stores to it seen so far, see constructKillSet
+    AssignmentMapType m_killMap;
+    LastWriteMapType m_lastWriteMap;
+    BitVector m_unknownDefinitions; // calls that may write every global and argument
+    unsigned m_numStores;
+    std::vector<BasicBlockDup> m_basicBlockDups;
 
     Function* m_previousFunction;
     Function* m_currentFunction;
+    bool m_isComputed;
     
-    UDChainMapType m_udChain;
+    // the definitions of a load or call are a range of m_definitions, the ranges
+    // are indexed by the instruction number of the load or call
+    std::vector<BufferRange> m_udChain;
+    std::vector<Instruction*> m_definitions;
+
+    const ValueNumbering* m_numbering;
+    const ModRef* m_modRef;
+    CoreOperandCache m_coreOperands;
+    InstructionIndex m_instructionIndex;
 
     public:
         static char ID;
 
         ReachingDef();
-        ~ReachingDef();
 
-        // Compute control dependences for all blocks in this function
+        // Only remember F, the reaching definitions are computed by compute. This
+        // way a function in which the client finds nothing to analyse costs nothing
         virtual bool runOnFunction(Function& F);
 
+        // Compute the reaching definitions of the current function unless that
+        // was done already. Every query below requires it
+        void compute(void);
+
+        // What runOnFunction does, for clients that run ReachingDef outside of
+        // a pass manager (see SILScheduler)
+        void setFunction(Function& function, const ValueNumbering& numbering, const ModRef& modRef);
+        bool isComputed(void) const { return m_isComputed; }
+
+        // Recompute the reaching definitions after function was transformed. The
+        // ValueNumbering must have been renumbered already. changedBlocks must hold
+        // every block that is new or whose instructions, predecessors or successors
+        // changed. Only the blocks reachable from them are solved again; the blocks
+        // whose in set changed are set in affectedBlocks (over the new block numbers)
+        void update(Function& function, const std::vector<BasicBlock*>& changedBlocks, BitVector& affectedBlocks);
+
         virtual void getAnalysisUsage(AnalysisUsage& AU) const;
-        std::vector<StoreInst*>& getDefinitions(LoadInst* loadInst); 
+        // the stores and calls that may define what a load or a call reads
+        Span<Instruction*> getDefinitions(Instruction* user) const; 
         Function* getCurrentFunction(void) { return m_currentFunction; }
 
+        // the loads, stores, phi nodes and branches of the current function, shared
+        // with the passes that run after this one
+        const InstructionIndex& getInstructionIndex(void) const { return m_instructionIndex; }
+
+        const ModRef& getModRef(void) const { return *m_modRef; }
+
+        // the resolved pointer operands of the current function
+        const CoreOperandCache& getCoreOperands(void) const { return m_coreOperands; }
+
         void printa(void);
 
         //print - Show contents in human readable format...
@@ -117,12 +148,20 @@ class ReachingDef : public FunctionPass
         
         void findDownwardsExposed(BasicBlock* block);
         
-        void constructGenSet(BasicBlock* block);
         void constructKillSet(BasicBlock* block);
         void constructInSets(Function& function);
+        void constructInSets(Function& function, const BitVector& blocks);
+        void remapSet(const BitVector& oldSet, BitVector& newSet, unsigned oldNumStores, const std::vector<unsigned>& callRemap) const;
+
+        unsigned getNumDefinitions(void) const { return m_numStores + m_instructionIndex.getNumCalls(); }
+        Instruction* getDefinition(unsigned definition) const;
+        void addDefinitionsOf(Value* coreOperand, BitVector& definitions) const;
+        void initializeSets(void);
         void constructUDChain(Function& function);
 
-        void findDefinitions(BasicBlockDup* blockDup, LoadInst* loadInst);
+        void findDefinitions(BasicBlockDup& blockDup, const InstructionIndex::LoadEntry& load);
+        void findDefinitions(BasicBlockDup& blockDup, const InstructionIndex::CallEntry& call);
+        void addUDChain(Instruction* user, BitVector& reaching);
 
 
 };
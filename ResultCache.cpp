@@ -0,0 +1,195 @@
+#include "ResultCache.h"
+#include "llvm/Instructions.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Analysis/DebugInfo.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+static const char* const Magic = "ielsections-cache 4";
+
+//64 bit FNV-1a
+static void hashString(uint64_t& value, const std::string& data)
+{
+    for (std::string::const_iterator i = data.begin(); i != data.end(); ++i)
+    {
+        value ^= (unsigned char)*i;
+        value *= 1099511628211ULL;
+    }
+}
+
+static void printSummary(raw_ostream& os, const ModRefSummary& summary)
+{
+    for (std::vector<GlobalVariable*>::const_iterator i = summary.ModGlobals.begin(); i != summary.ModGlobals.end(); ++i)
+    {
+        os << " mod @" << (*i)->getName();
+    }
+    for (std::vector<GlobalVariable*>::const_iterator i = summary.RefGlobals.begin(); i != summary.RefGlobals.end(); ++i)
+    {
+        os << " ref @" << (*i)->getName();
+    }
+    for (std::vector<unsigned>::const_iterator i = summary.ModArguments.begin(); i != summary.ModArguments.end(); ++i)
+    {
+        os << " mod " << *i;
+    }
+    for (std::vector<unsigned>::const_iterator i = summary.RefArguments.begin(); i != summary.RefArguments.end(); ++i)
+    {
+        os << " ref " << *i;
+    }
+
+    os << (summary.ModUnknown ? " mod ?" : "") << (summary.RefUnknown ? " ref ?" : "");
+}
+
+//the printed IR leaves out the contents of the debug metadata, so the locations are
+//added one instruction at a time; and what SIL assumes about a call depends on the
+//summary of the callee, which may have changed in another function or module
+uint64_t ResultCache::getKey(Function& function, const ModRef& modRef, const std::string& options)
+{
+    std::string text;
+    raw_string_ostream os(text);
+
+    os << options << "\n";
+    function.print(os);
+
+    for (Function::iterator block = function.begin(); block != function.end(); ++block)
+    {
+        for (BasicBlock::iterator instr = block->begin(); instr != block->end(); ++instr)
+        {
+            if (MDNode* node = instr->getMetadata("dbg"))
+            {
+                DILocation location(node);
+                os << location.getLineNumber() << " " << location.getFilename() << "\n";
+            }
+
+            if (!isa<CallInst>(instr) && !isa<InvokeInst>(instr)) continue;
+
+            Function* callee = CallSite::get(instr).getCalledFunction();
+            if (callee == NULL) continue;
+
+            os << callee->getName() << ":";
+            if (const ModRefSummary* summary = modRef.getSummary(callee))
+            {
+                printSummary(os, *summary);
+            }
+            else
+            {
+                os << (callee->doesNotAccessMemory() ? " readnone" : callee->onlyReadsMemory() ? " readonly" : " unknown");
+            }
+            os << "\n";
+        }
+    }
+
+    uint64_t value = 14695981039346656037ULL;
+    hashString(value, os.str());
+    return value;
+}
+
+std::string ResultCache::getPath(uint64_t key) const
+{
+    char name[17];
+    sprintf(name, "%016llx", (unsigned long long)key);
+    return m_directory + "/" + name;
+}
+
+//read count bytes that follow a "name count" line
+static bool readBlock(std::istream& is, const char* name, std::string& data)
+{
+    std::string line;
+    std::string field;
+    size_t size;
+
+    if (!std::getline(is, line)) return false;
+
+    std::istringstream fields(line);
+    if (!(fields >> field >> size) || field != name) return false;
+
+    data.resize(size);
+    return size == 0 || is.read(&data[0], size);
+}
+
+bool ResultCache::lookup(uint64_t key, Entry& entry) const
+{
+    std::ifstream file(getPath(key).c_str(), std::ios::in | std::ios::binary);
+    if (!file) return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != Magic) return false;
+
+    std::string field;
+    Counts& counts = entry.counts;
+    if (!std::getline(file, line)) return false;
+
+    std::istringstream countFields(line);
+    if (!(countFields >> field >> counts.totalLoops >> counts.afterFinalCheck >> counts.budgetExceeded >> counts.cold) || field != "counts")
+    {
+        return false;
+    }
+
+    int depth;
+    counts.histogram.clear();
+    while (countFields >> depth)
+    {
+        counts.histogram.push_back(depth);
+    }
+
+    std::string records;
+    if (!readBlock(file, "records", records)) return false;
+
+    std::istringstream lines(records);
+    entry.records.clear();
+    while (std::getline(lines, line))
+    {
+        entry.records.push_back(IELSectionRecord());
+        if (!entry.records.back().parse(line)) return false;
+    }
+
+    return readBlock(file, "out", entry.out) && readBlock(file, "err", entry.err);
+}
+
+void ResultCache::store(uint64_t key, const Entry& entry) const
+{
+    std::ostringstream records;
+    for (std::vector<IELSectionRecord>::const_iterator i = entry.records.begin(); i != entry.records.end(); ++i)
+    {
+        i->printWithTiming(records);
+    }
+
+    std::string path = getPath(key);
+    std::ostringstream temporary;
+    temporary << path << ".tmp." << getpid() << "." << (unsigned long)pthread_self();
+
+    {
+        std::ofstream file(temporary.str().c_str(), std::ios::out | std::ios::binary);
+        if (!file) return;
+
+        file << Magic << "\n";
+        file << "counts " << entry.counts.totalLoops << " " << entry.counts.afterFinalCheck << " "
+             << entry.counts.budgetExceeded << " " << entry.counts.cold;
+        for (std::vector<int>::const_iterator i = entry.counts.histogram.begin(); i != entry.counts.histogram.end(); ++i)
+        {
+            file << " " << *i;
+        }
+        file << "\n";
+        file << "records " << records.str().size() << "\n" << records.str();
+        file << "out " << entry.out.size() << "\n" << entry.out;
+        file << "err " << entry.err.size() << "\n" << entry.err;
+
+        if (!file)
+        {
+            file.close();
+            remove(temporary.str().c_str());
+            return;
+        }
+    }
+
+    if (rename(temporary.str().c_str(), path.c_str()) != 0)
+    {
+        remove(temporary.str().c_str());
+    }
+}
@@ -0,0 +1,61 @@
+#include "llvm/Function.h"
+#include "llvm/System/DataTypes.h"
+#include "ModRef/ModRef.h"
+#include "IELSectionRecord.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+//directory of the results of earlier runs, one file per function. A file is named
+//after a hash of everything the analysis of the function depends on: its IR and
+//debug locations, the ModRef summaries of its callees and the options. An unchanged
+//function is answered from its file without computing any analysis
+class ResultCache
+{
+    public:
+
+        //the loop counts and the depth histogram of the function, see SIL::Counts
+        struct Counts
+        {
+            Counts() : totalLoops(0), afterFinalCheck(0), budgetExceeded(0), cold(0) {}
+            int totalLoops;
+            int afterFinalCheck;
+            int budgetExceeded;
+            int cold;
+            std::vector<int> histogram;
+        };
+
+        //what the analysis of one function found and printed
+        struct Entry
+        {
+            std::vector<IELSectionRecord> records;
+            Counts counts;
+            std::string out;
+            std::string err;
+        };
+
+        bool isEnabled(void) const { return !m_directory.empty(); }
+        void setDirectory(const std::string& directory) { m_directory = directory; }
+
+        //options must describe every option that changes the result or the output
+        static uint64_t getKey(Function& function, const ModRef& modRef, const std::string& options);
+
+        //return false if there is no valid entry for key
+        bool lookup(uint64_t key, Entry& entry) const;
+
+        //the entry is written to a temporary file first and renamed, so concurrent
+        //runs sharing the directory never read a partial entry
+        void store(uint64_t key, const Entry& entry) const;
+
+    private:
+        std::string getPath(uint64_t key) const;
+
+    private:
+        std::string m_directory;
+};
+
+#endif //RESULTCACHE_H
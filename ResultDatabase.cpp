@@ -0,0 +1,357 @@
+#include "ResultDatabase.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+const char ResultDatabase::Magic[8] = {'I', 'E', 'L', 'D', 'B', 0, 0, 1};
+
+namespace
+{
+    //assigns every distinct string one offset into the string table
+    class StringTable
+    {
+        public:
+            uint32_t intern(const std::string& s)
+            {
+                std::map<std::string, uint32_t>::iterator where = m_offsets.find(s);
+                if (where != m_offsets.end()) return where->second;
+
+                uint32_t offset = m_data.size();
+                m_data.append(s.c_str(), s.size() + 1);
+                m_offsets[s] = offset;
+                return offset;
+            }
+
+            const std::string& getData(void) const { return m_data; }
+
+        private:
+            std::map<std::string, uint32_t> m_offsets;
+            std::string m_data;
+    };
+
+    //orders records by source file and first line
+    class FileLess
+    {
+        public:
+            FileLess(const std::vector<IELSectionRecord>& records) : m_records(records) {}
+
+            bool operator()(unsigned int a, unsigned int b) const
+            {
+                int order = m_records[a].sourceFile.compare(m_records[b].sourceFile);
+                return order != 0 ? order < 0 : m_records[a].firstLine < m_records[b].firstLine;
+            }
+
+        private:
+            const std::vector<IELSectionRecord>& m_records;
+    };
+
+    //orders record numbers by the name of their function
+    class FunctionLess
+    {
+        public:
+            FunctionLess(const ResultDatabase& database) : m_database(database) {}
+
+            bool operator()(uint32_t a, uint32_t b) const { return strcmp(getName(a), getName(b)) < 0; }
+            bool operator()(uint32_t a, const char* b) const { return strcmp(getName(a), b) < 0; }
+            bool operator()(const char* a, uint32_t b) const { return strcmp(a, getName(b)) < 0; }
+
+        private:
+            const char* getName(uint32_t i) const { return m_database.getString(m_database.getRecord(i).function); }
+
+            const ResultDatabase& m_database;
+    };
+
+    //orders the records of one file by first line
+    struct FirstLineLess
+    {
+        bool operator()(const ResultDatabase::Record& a, int line) const { return a.firstLine < line; }
+        bool operator()(int line, const ResultDatabase::Record& b) const { return line < b.firstLine; }
+        bool operator()(const ResultDatabase::Record& a, const ResultDatabase::Record& b) const { return a.firstLine < b.firstLine; }
+    };
+}
+
+bool ResultDatabase::write(const std::string& filename, const std::vector<IELSectionRecord>& records, std::string& error)
+{
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0; i < records.size(); ++i)
+    {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), FileLess(records));
+
+    StringTable strings;
+    std::vector<Record> stored;
+    std::vector<File> files;
+
+    for (std::vector<unsigned int>::iterator i = order.begin(); i != order.end(); ++i)
+    {
+        const IELSectionRecord& record = records[*i];
+
+        Record entry;
+        entry.function = strings.intern(record.function);
+        entry.header = strings.intern(record.header);
+        entry.sourceFile = strings.intern(record.sourceFile);
+        entry.firstLine = record.firstLine;
+        entry.lastLine = record.lastLine;
+        entry.verdict = record.verdict;
+        entry.numParameters = record.numParameters;
+        entry.numCheckSites = record.numCheckSites;
+
+        if (files.empty() || files.back().name != entry.sourceFile)
+        {
+            File file;
+            file.name = entry.sourceFile;
+            file.begin = stored.size();
+            file.end = stored.size();
+            file.maxSpan = 0;
+            files.push_back(file);
+        }
+
+        files.back().end = stored.size() + 1;
+        if (entry.firstLine <= entry.lastLine)
+        {
+            files.back().maxSpan = std::max(files.back().maxSpan, entry.lastLine - entry.firstLine);
+        }
+        stored.push_back(entry);
+    }
+
+    //the function index is sorted through the strings, which are only known now
+    Header header;
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.numRecords = stored.size();
+    header.numFiles = files.size();
+    header.recordsOffset = sizeof(Header);
+    header.filesOffset = header.recordsOffset + stored.size() * sizeof(Record);
+    header.byFunctionOffset = header.filesOffset + files.size() * sizeof(File);
+    header.stringsOffset = header.byFunctionOffset + stored.size() * sizeof(uint32_t);
+    header.stringsSize = strings.getData().size();
+
+    std::string data(header.stringsOffset + header.stringsSize, '\0');
+    memcpy(&data[0], &header, sizeof(Header));
+    if (!stored.empty()) memcpy(&data[header.recordsOffset], &stored[0], stored.size() * sizeof(Record));
+    if (!files.empty()) memcpy(&data[header.filesOffset], &files[0], files.size() * sizeof(File));
+    memcpy(&data[header.stringsOffset], strings.getData().data(), header.stringsSize);
+
+    ResultDatabase database;
+    database.m_data = data.data();
+    database.m_size = data.size();
+
+    std::vector<uint32_t> byFunction;
+    for (uint32_t i = 0; i < stored.size(); ++i)
+    {
+        byFunction.push_back(i);
+    }
+    std::stable_sort(byFunction.begin(), byFunction.end(), FunctionLess(database));
+    database.m_data = NULL;
+
+    if (!byFunction.empty()) memcpy(&data[header.byFunctionOffset], &byFunction[0], byFunction.size() * sizeof(uint32_t));
+
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!file || !file.write(data.data(), data.size()))
+    {
+        error = "can not write " + filename;
+        return false;
+    }
+
+    return true;
+}
+
+bool ResultDatabase::open(const std::string& filename, std::string& error)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "can not open " + filename;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(Header))
+    {
+        ::close(fd);
+        error = filename + " is not a result database";
+        return false;
+    }
+
+    void* data = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        error = "can not map " + filename;
+        return false;
+    }
+
+    m_data = static_cast<const char*>(data);
+    m_size = status.st_size;
+
+    if (!isValid())
+    {
+        close();
+        error = filename + " is not a result database";
+        return false;
+    }
+
+    return true;
+}
+
+//the sections must follow each other without gaps and fill the file, every string
+//offset must be inside the string table, which ends with a terminator, and every
+//record index must be in range
+bool ResultDatabase::isValid(void) const
+{
+    const Header& header = getHeader();
+    uint64_t filesOffset = (uint64_t)header.recordsOffset + (uint64_t)header.numRecords * sizeof(Record);
+    uint64_t byFunctionOffset = filesOffset + (uint64_t)header.numFiles * sizeof(File);
+    uint64_t stringsOffset = byFunctionOffset + (uint64_t)header.numRecords * sizeof(uint32_t);
+
+    if (memcmp(header.magic, Magic, sizeof(Magic)) != 0
+            || header.recordsOffset != sizeof(Header)
+            || header.filesOffset != filesOffset
+            || header.byFunctionOffset != byFunctionOffset
+            || header.stringsOffset != stringsOffset
+            || stringsOffset + header.stringsSize != m_size)
+    {
+        return false;
+    }
+
+    uint32_t stringsSize = header.stringsSize;
+    if (stringsSize != 0 && m_data[header.stringsOffset + stringsSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    const Record* records = getRecords();
+    for (uint32_t i = 0; i < header.numRecords; ++i)
+    {
+        if (records[i].function >= stringsSize || records[i].header >= stringsSize || records[i].sourceFile >= stringsSize
+                || records[i].verdict > IELSectionRecord::Cold)
+        {
+            return false;
+        }
+    }
+
+    const File* files = getFiles();
+    for (uint32_t i = 0; i < header.numFiles; ++i)
+    {
+        if (files[i].name >= stringsSize || files[i].begin > files[i].end || files[i].end > header.numRecords || files[i].maxSpan < 0)
+        {
+            return false;
+        }
+    }
+
+    const uint32_t* byFunction = getByFunction();
+    for (uint32_t i = 0; i < header.numRecords; ++i)
+    {
+        if (byFunction[i] >= header.numRecords)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ResultDatabase::close(void)
+{
+    if (m_data != NULL)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+        m_data = NULL;
+        m_size = 0;
+    }
+}
+
+bool ResultDatabase::parseRange(const std::string& range, std::string& file, int& firstLine, int& lastLine)
+{
+    std::string::size_type colon = range.rfind(':');
+    if (colon == std::string::npos) return false;
+
+    file = range.substr(0, colon);
+    const char* lines = range.c_str() + colon + 1;
+    char* end;
+
+    firstLine = strtol(lines, &end, 10);
+    if (end == lines) return false;
+
+    lastLine = firstLine;
+    if (*end == '-')
+    {
+        lines = end + 1;
+        lastLine = strtol(lines, &end, 10);
+        if (end == lines) return false;
+    }
+
+    return *end == '\0';
+}
+
+void ResultDatabase::findByLineRange(const char* sourceFile, int firstLine, int lastLine, std::vector<unsigned int>& records) const
+{
+    const File* files = getFiles();
+    const File* filesEnd = files + getHeader().numFiles;
+
+    //binary search for the file, the files are sorted by name
+    while (files != filesEnd)
+    {
+        const File* middle = files + (filesEnd - files) / 2;
+        int order = strcmp(getString(middle->name), sourceFile);
+
+        if (order == 0)
+        {
+            //a loop that starts more than maxSpan lines before firstLine ends before it
+            const Record* begin = getRecords() + middle->begin;
+            const Record* end = getRecords() + middle->end;
+            int from = firstLine < INT_MIN + middle->maxSpan ? INT_MIN : firstLine - middle->maxSpan;
+            const Record* first = std::lower_bound(begin, end, from, FirstLineLess());
+            const Record* last = std::upper_bound(first, end, lastLine, FirstLineLess());
+
+            for (const Record* i = first; i != last; ++i)
+            {
+                if (i->lastLine >= firstLine)
+                {
+                    records.push_back(i - getRecords());
+                }
+            }
+            return;
+        }
+
+        if (order < 0)
+        {
+            files = middle + 1;
+        }
+        else
+        {
+            filesEnd = middle;
+        }
+    }
+}
+
+void ResultDatabase::findByFunction(const char* function, std::vector<unsigned int>& records) const
+{
+    const uint32_t* begin = getByFunction();
+    const uint32_t* end = begin + getNumRecords();
+
+    std::pair<const uint32_t*, const uint32_t*> range = std::equal_range(begin, end, function, FunctionLess(*this));
+    records.insert(records.end(), range.first, range.second);
+}
+
+void ResultDatabase::print(unsigned int i, std::ostream& os) const
+{
+    const Record& record = getRecord(i);
+    const char* sourceFile = getString(record.sourceFile);
+
+    os << getString(record.function) << " " << getString(record.header) << " " << record.firstLine << "-" << record.lastLine << " "
+       << (*sourceFile == '\0' ? "-" : sourceFile) << " " << IELSectionRecord::getVerdictName((IELSectionRecord::Verdict)record.verdict) << " "
+       << record.numParameters << " " << record.numCheckSites << "\n";
+}
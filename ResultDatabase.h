@@ -0,0 +1,102 @@
+#include "llvm/System/DataTypes.h"
+#include "IELSectionRecord.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+#ifndef RESULTDATABASE_H
+#define RESULTDATABASE_H
+
+//a file of IELSectionRecords that is mapped instead of read. All names are interned
+//in one string table, the records are sorted by source file and first line, and every
+//source file has the range of its records, so a line range query is two binary
+//searches. A second index orders the records by function.
+//
+//The file is written in the byte order of the machine that writes it
+class ResultDatabase
+{
+    public:
+
+        //one record as it is stored, the names are offsets into the string table
+        struct Record
+        {
+            uint32_t function;
+            uint32_t header;
+            uint32_t sourceFile;
+            int32_t firstLine;
+            int32_t lastLine;
+            uint32_t verdict;
+            uint32_t numParameters;
+            uint32_t numCheckSites;
+        };
+
+        ResultDatabase() : m_data(NULL), m_size(0) {}
+        ~ResultDatabase() { close(); }
+
+        //return false and describe the problem in error if filename can not be written
+        static bool write(const std::string& filename, const std::vector<IELSectionRecord>& records, std::string& error);
+
+        //map filename, return false and describe the problem in error if it is not a
+        //result database
+        bool open(const std::string& filename, std::string& error);
+        void close(void);
+
+        unsigned int getNumRecords(void) const { return getHeader().numRecords; }
+        const Record& getRecord(unsigned int i) const { return getRecords()[i]; }
+        const char* getString(uint32_t offset) const { return m_data + getHeader().stringsOffset + offset; }
+
+        //split file:first-last or file:line, the line ranges findByLineRange takes, return
+        //false if range is malformed
+        static bool parseRange(const std::string& range, std::string& file, int& firstLine, int& lastLine);
+
+        //append the records of all loops of sourceFile whose line range overlaps [firstLine, lastLine]
+        void findByLineRange(const char* sourceFile, int firstLine, int lastLine, std::vector<unsigned int>& records) const;
+
+        //append the records of all loops analysed in function
+        void findByFunction(const char* function, std::vector<unsigned int>& records) const;
+
+        //the record in the one line format of IELSectionRecord::print
+        void print(unsigned int i, std::ostream& os) const;
+
+    private:
+        struct Header
+        {
+            char magic[8];
+            uint32_t numRecords;
+            uint32_t numFiles;
+            uint32_t recordsOffset;
+            uint32_t filesOffset;
+            uint32_t byFunctionOffset;
+            uint32_t stringsOffset;
+            uint32_t stringsSize;
+        };
+
+        //the records of one source file are [begin, end), maxSpan is the largest
+        //lastLine - firstLine among them. Loops without debug information have no
+        //line range and do not count
+        struct File
+        {
+            uint32_t name;
+            uint32_t begin;
+            uint32_t end;
+            int32_t maxSpan;
+        };
+
+        //check every offset and index of the mapped file once, so that the lookups
+        //can trust them
+        bool isValid(void) const;
+
+        const Header& getHeader(void) const { return *reinterpret_cast<const Header*>(m_data); }
+        const Record* getRecords(void) const { return reinterpret_cast<const Record*>(m_data + getHeader().recordsOffset); }
+        const File* getFiles(void) const { return reinterpret_cast<const File*>(m_data + getHeader().filesOffset); }
+        const uint32_t* getByFunction(void) const { return reinterpret_cast<const uint32_t*>(m_data + getHeader().byFunctionOffset); }
+
+        static const char Magic[8];
+
+    private:
+        const char* m_data;
+        size_t m_size;
+};
+
+#endif //RESULTDATABASE_H
@@ -0,0 +1,198 @@
+#include "ResultWriter.h"
+#include <cassert>
+#include <cstdio>
+#include <pthread.h>
+
+using namespace llvm;
+
+static pthread_mutex_t headerLock = PTHREAD_MUTEX_INITIALIZER;
+static bool isHeaderWritten = false;
+
+ResultWriter* ResultWriter::create(Format format)
+{
+    switch (format)
+    {
+        case None:
+            return NULL;
+
+        case Text:
+            return new TextResultWriter();
+
+        case JSONLines:
+            return new JSONLinesResultWriter();
+
+        case CSV:
+            return new CSVResultWriter();
+    }
+
+    assert(false && "unknown format");
+    return NULL;
+}
+
+void ResultWriter::begin(std::ostream& os)
+{
+    pthread_mutex_lock(&headerLock);
+    if (!isHeaderWritten)
+    {
+        writeHeader(os);
+        os.flush();
+        isHeaderWritten = true;
+    }
+    pthread_mutex_unlock(&headerLock);
+}
+
+void ResultWriter::flush(std::ostream& os)
+{
+    const std::string& output = m_buffer.str();
+    if (output.empty()) return;
+
+    os << output;
+    os.flush();
+    m_buffer.str("");
+}
+
+void TextResultWriter::write(const IELSectionRecord& record)
+{
+    m_buffer << "Function: " << record.function << "\n";
+    m_buffer << "Loop header: " << record.header << "\n";
+    m_buffer << "Range: " << record.firstLine << "-" << record.lastLine << "\n";
+    m_buffer << "Source file: " << (record.sourceFile.empty() ? "-" : record.sourceFile) << "\n";
+    m_buffer << "Verdict: " << IELSectionRecord::getVerdictName(record.verdict);
+    if (record.rejectionStep != IELSectionRecord::NotRejected)
+    {
+        m_buffer << " in " << IELSectionRecord::getRejectionStepName(record.rejectionStep);
+    }
+    m_buffer << "\n";
+    m_buffer << "Parameters: " << record.numParameters << "\n";
+    m_buffer << "Check sites: " << record.numCheckSites << "\n";
+    m_buffer << "Time: " << record.microseconds << " us\n\n";
+}
+
+void TextResultWriter::writeCounts(const std::string& function, const FunctionCounts& counts)
+{
+    m_buffer << "Function: " << function << "\n";
+    m_buffer << "Loop count: " << counts.loops << "\n";
+    m_buffer << "After final check: " << counts.accepted << "\n";
+    m_buffer << "Budget exceeded: " << counts.budgetExceeded << "\n";
+    m_buffer << "Cold: " << counts.cold << "\n";
+    for (unsigned int i = 1; i < counts.depthHistogram.size(); ++i)
+    {
+        m_buffer << "Loop depth: " << i << " " << counts.depthHistogram[i] << "\n";
+    }
+    m_buffer << "\n";
+}
+
+void JSONLinesResultWriter::writeString(const std::string& value)
+{
+    m_buffer << '"';
+    for (std::string::const_iterator i = value.begin(); i != value.end(); ++i)
+    {
+        unsigned char c = *i;
+        if (c == '"' || c == '\\')
+        {
+            m_buffer << '\\' << c;
+        }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", c);
+            m_buffer << escaped;
+        }
+        else
+        {
+            m_buffer << c;
+        }
+    }
+    m_buffer << '"';
+}
+
+void JSONLinesResultWriter::write(const IELSectionRecord& record)
+{
+    m_buffer << "{\"type\":\"loop\",\"function\":";
+    writeString(record.function);
+    m_buffer << ",\"header\":";
+    writeString(record.header);
+    m_buffer << ",\"file\":";
+    if (record.sourceFile.empty())
+    {
+        m_buffer << "null";
+    }
+    else
+    {
+        writeString(record.sourceFile);
+    }
+    m_buffer << ",\"first_line\":" << record.firstLine
+             << ",\"last_line\":" << record.lastLine
+             << ",\"verdict\":\"" << IELSectionRecord::getVerdictName(record.verdict) << "\""
+             << ",\"rejection_step\":";
+    if (record.rejectionStep == IELSectionRecord::NotRejected)
+    {
+        m_buffer << "null";
+    }
+    else
+    {
+        m_buffer << "\"" << IELSectionRecord::getRejectionStepName(record.rejectionStep) << "\"";
+    }
+    m_buffer << ",\"parameters\":" << record.numParameters
+             << ",\"check_sites\":" << record.numCheckSites
+             << ",\"microseconds\":" << record.microseconds << "}\n";
+}
+
+void JSONLinesResultWriter::writeCounts(const std::string& function, const FunctionCounts& counts)
+{
+    m_buffer << "{\"type\":\"counts\",\"function\":";
+    writeString(function);
+    m_buffer << ",\"loops\":" << counts.loops
+             << ",\"accepted\":" << counts.accepted
+             << ",\"budget_exceeded\":" << counts.budgetExceeded
+             << ",\"cold\":" << counts.cold
+             << ",\"depth_histogram\":{";
+    for (unsigned int i = 1; i < counts.depthHistogram.size(); ++i)
+    {
+        m_buffer << (i == 1 ? "" : ",") << "\"" << i << "\":" << counts.depthHistogram[i];
+    }
+    m_buffer << "}}\n";
+}
+
+//quoted only when needed, as RFC 4180 describes
+void CSVResultWriter::writeField(const std::string& value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        m_buffer << value;
+        return;
+    }
+
+    m_buffer << '"';
+    for (std::string::const_iterator i = value.begin(); i != value.end(); ++i)
+    {
+        if (*i == '"')
+        {
+            m_buffer << '"';
+        }
+        m_buffer << *i;
+    }
+    m_buffer << '"';
+}
+
+void CSVResultWriter::writeHeader(std::ostream& os)
+{
+    os << "function,header,file,first_line,last_line,verdict,rejection_step,parameters,check_sites,microseconds\n";
+}
+
+void CSVResultWriter::write(const IELSectionRecord& record)
+{
+    writeField(record.function);
+    m_buffer << ",";
+    writeField(record.header);
+    m_buffer << ",";
+    writeField(record.sourceFile);
+    m_buffer << "," << record.firstLine << "," << record.lastLine
+             << "," << IELSectionRecord::getVerdictName(record.verdict) << ",";
+    if (record.rejectionStep != IELSectionRecord::NotRejected)
+    {
+        m_buffer << IELSectionRecord::getRejectionStepName(record.rejectionStep);
+    }
+    m_buffer << "," << record.numParameters << "," << record.numCheckSites
+             << "," << record.microseconds << "\n";
+}
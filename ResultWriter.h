@@ -0,0 +1,96 @@
+#include "IELSectionRecord.h"
+#include <string>
+#include <sstream>
+#include <ostream>
+#include <vector>
+
+using namespace llvm;
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+//formats the records of the analysed loops, one record per loop, for -iel:format.
+//The output of a function is collected in the writer and written with a single call
+//by flush, so a writer is never shared between threads and the output of functions
+//analysed concurrently (see SILScheduler) is not interleaved
+class ResultWriter
+{
+    public:
+
+        enum Format
+        {
+            None, //the free text output of -iel:print-counts and friends
+            Text,
+            JSONLines,
+            CSV
+        };
+
+        //the counts of one function, see SIL::Counts. depthHistogram[d] is the number
+        //of IE/L sections whose loop nest is d deep (-iel:outer-loops only), index 0
+        //is unused
+        struct FunctionCounts
+        {
+            FunctionCounts() : loops(0), accepted(0), budgetExceeded(0), cold(0) {}
+            int loops;
+            int accepted;
+            int budgetExceeded;
+            int cold;
+            std::vector<int> depthHistogram;
+        };
+
+        virtual ~ResultWriter() {}
+
+        //return NULL for None
+        static ResultWriter* create(Format format);
+
+        //write the header of the format to os, only once per process however many
+        //modules or threads are analysed
+        void begin(std::ostream& os);
+
+        virtual void write(const IELSectionRecord& record) = 0;
+        virtual void writeCounts(const std::string& function, const FunctionCounts& counts) = 0;
+
+        //write what was collected since the last flush to os
+        void flush(std::ostream& os);
+
+    protected:
+        virtual void writeHeader(std::ostream& os) {}
+
+        std::ostringstream m_buffer;
+};
+
+//the same lines IELSection::print writes for an accepted loop, for every loop
+class TextResultWriter : public ResultWriter
+{
+    public:
+        virtual void write(const IELSectionRecord& record);
+        virtual void writeCounts(const std::string& function, const FunctionCounts& counts);
+};
+
+//one JSON object per line, "type" is "loop" or "counts"
+class JSONLinesResultWriter : public ResultWriter
+{
+    public:
+        virtual void write(const IELSectionRecord& record);
+        virtual void writeCounts(const std::string& function, const FunctionCounts& counts);
+
+    private:
+        void writeString(const std::string& value);
+};
+
+//one row per loop. The counts can be summed up from the rows and are left out, and
+//so is the depth histogram, which has no row of its own
+class CSVResultWriter : public ResultWriter
+{
+    public:
+        virtual void write(const IELSectionRecord& record);
+        virtual void writeCounts(const std::string& function, const FunctionCounts& counts) {}
+
+    protected:
+        virtual void writeHeader(std::ostream& os);
+
+    private:
+        void writeField(const std::string& value);
+};
+
+#endif //RESULTWRITER_H
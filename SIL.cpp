@@ -1,6 +1,11 @@
 #include "SIL.h"
 #include "llvm/Support/CommandLine.h"
+#include "SILTrace.h"
+#include "llvm/System/Path.h"
 #include "utils.h"
+#include <algorithm>
+#include <sstream>
+#include <pthread.h>
 
 using namespace llvm;
 
@@ -9,95 +14,335 @@ cl::opt<bool> printRejected("iel:print-rejected", cl::desc("Print rejected candi
 cl::opt<bool> printCount("iel:print-counts", cl::desc("Print the number of IE/L-sections and IE/L-section candidates"));
 cl::opt<bool> outerLoops("iel:outer-loops", cl::desc("Check outer loops first"));
 cl::opt<bool> skipEmptyBodyLoops("iel:skip-empty-body-loops", cl::desc("Skill all loops with empty bodies"));
+cl::opt<bool> explain("iel:explain", cl::desc("Finish the analysis of rejected loops instead of stopping at the first False array index or branch condition, and print rejection paths with -iel:print-rejected"));
+cl::opt<unsigned> loopBudget("iel:loop-budget", cl::desc("Maximum number of parameter visits spent on a loop (0 = unlimited)"), cl::init(0));
+cl::opt<unsigned> loopTimeBudget("iel:loop-time-budget", cl::desc("Maximum wall time in milliseconds spent on a loop (0 = unlimited)"), cl::init(0));
+cl::opt<unsigned> functionBudget("iel:function-budget", cl::desc("Maximum number of parameter visits spent on a function, the reaching definitions and control dependences count one per instruction and block (0 = unlimited)"), cl::init(0));
+cl::opt<unsigned> functionTimeBudget("iel:function-time-budget", cl::desc("Maximum wall time in milliseconds spent on a function (0 = unlimited)"), cl::init(0));
+cl::opt<bool> streamRecords("iel:stream", cl::desc("Print a one line record for every analysed loop at the end of each function instead of keeping the records in memory"));
+cl::opt<std::string> profileFile("iel:profile", cl::desc("Read function and loop execution counts from filename and analyse the loops hottest first"), cl::value_desc("filename"));
+cl::opt<unsigned> hotCount("iel:hot-count", cl::desc("Loops that ran at least this many times according to -iel:profile get -iel:hot-budget-scale times the loop budgets"), cl::init(1000));
+cl::opt<unsigned> hotBudgetScale("iel:hot-budget-scale", cl::desc("Factor applied to the loop budgets of hot loops"), cl::init(4));
+cl::opt<unsigned> coldCount("iel:cold-count", cl::desc("Do not analyse loops that ran fewer times than this according to -iel:profile"), cl::init(0));
+cl::opt<unsigned> silThreads("iel:threads", cl::desc("Compute the reaching definitions and control dependences of a function concurrently, and with -iel-parallel analyse that many functions at once (0 = one per processor)"), cl::init(1));
+cl::opt<std::string> cacheDirectory("iel:cache-dir", cl::desc("Keep the results of every function with a loop in directory and reuse them while the function, its callees and the options stay the same"), cl::value_desc("directory"));
+cl::opt<std::string> databaseFile("iel:db", cl::desc("Write the records of the module to a result database for iel-query"), cl::value_desc("filename"));
+cl::opt<ResultWriter::Format> outputFormat("iel:format", cl::desc("Print one record for every analysed loop, with its rejection step and time, instead of the free text output"),
+    cl::values(clEnumValN(ResultWriter::Text, "text", "human readable"),
+               clEnumValN(ResultWriter::JSONLines, "jsonl", "one JSON object per line"),
+               clEnumValN(ResultWriter::CSV, "csv", "comma separated values with a header row"),
+               clEnumValEnd),
+    cl::init(ResultWriter::None));
+cl::opt<bool> demandDriven("iel:demand-driven", cl::desc("Only evaluate the parameters that array indices and branch conditions depend on"));
 
 char SIL::ID = 0;
 static RegisterPass<SIL> sil("iel", "find all IE/L sections");
 
-SIL::SIL()
+//orders (count, loop) pairs by decreasing count
+struct HotterThan
+{
+    bool operator()(const std::pair<uint64_t, Loop*>& a, const std::pair<uint64_t, Loop*>& b) const
+    {
+        return a.first > b.first;
+    }
+};
+
+SIL::SIL(bool writeGraph)
     :   //LoopPass(&ID),
         FunctionPass(&ID),
         m_currentReachingDef(NULL),
+        m_currentControlDependence(NULL),
+        m_currentNumbering(NULL),
+        m_currentLoopInfo(NULL),
+        m_writer(NULL),
         m_id(0)
 {
 //    std::string filename = "/home/singri/llvm-2.7/llvm/lib/Analysis/ielsections/Untitled1";
-    std::string filename = graphFile.c_str();
-    m_file.open(filename.c_str(), std::fstream::out);
-    m_file << "digraph{\n";
+    m_definitionCache.setBudgets(&m_loopBudget, &m_functionBudget);
+
+    if (writeGraph)
+    {
+        std::string filename = graphFile.c_str();
+        m_file.open(filename.c_str(), std::fstream::out);
+        m_file << "digraph{\n";
+    }
 }
 
 SIL::~SIL()
 {
-    m_file << "\n}";
-    m_file.close();
+    releaseSections();
+    delete m_writer;
+
+    if (m_file.is_open())
+    {
+        m_file << "\n}";
+        m_file.close();
+    }
 }
 
-//perform step1 as per the paper and at the same time construct set RD for each triplet
-void SIL::runStep1(IELSection* ielSection)
+//the sections point into the IR and LoopInfo of one function, so they must not
+//outlive it. Their records are kept unless they have been streamed out already
+void SIL::releaseSections(void)
 {
-    assert(ielSection != NULL);
-    SILParameterList& silParameters = ielSection->getSILParameters();
+    for (std::vector<IELSection*>::iterator i = m_ielSections.begin(); i != m_ielSections.end(); ++i)
+    {
+        delete *i;
+    }
 
-    for (SILParameterList::iterator i = silParameters.begin(); i != silParameters.end(); ++i)
+    m_ielSections.clear();
+    m_loops.clear();
+
+    if (streamRecords)
     {
-        SILParameter* currentParameter = *i;
-        currentParameter->constructDefinitionList(m_currentReachingDef);
-       
-        bool isInside = false, isOutside = false;
-        Loop* loop = ielSection->getLoop();
+        m_result.clear();
+    }
+}
 
-        for (unsigned int j = 0; j < currentParameter->getNumDefinitions(); ++j)
+void SIL::releaseMemory(void)
+{
+    releaseSections();
+}
+
+//with -iel:format the records of the function go through the writer whether or not
+//they are kept, and are written to ielOut in one piece. This happens after the output
+//of the function was captured for the cache, so a cache hit writes the records with
+//the time of this run, which is 0, instead of replaying the output of the run that
+//stored them
+void SIL::writeRecords(Function& function)
+{
+    if (m_writer != NULL)
+    {
+        std::vector<IELSectionRecord> records;
+        m_result.getFunctionRecords(records);
+        for (std::vector<IELSectionRecord>::const_iterator i = records.begin(); i != records.end(); ++i)
         {
-            BasicBlock* parent = currentParameter->getDefinitionParent(j);
+            m_writer->write(*i);
+        }
 
-            if (loop->contains(parent) && loop->getHeader() != parent)
-            {
-                currentParameter->addRD(j);
-                isInside = true;
-            }
-            else
-            {
-                isOutside = true;
-            }
+        if (printCount && m_counts.totalLoops != 0)
+        {
+            ResultWriter::FunctionCounts counts;
+            counts.loops = m_counts.totalLoops;
+            counts.accepted = m_counts.afterFinalCheck;
+            counts.budgetExceeded = m_counts.budgetExceeded;
+            counts.cold = m_counts.cold;
+            counts.depthHistogram = m_histogram;
+            m_writer->writeCounts(function.getName().str(), counts);
         }
 
-        if (isInside && isOutside)
+        m_writer->flush(ielOut());
+    }
+}
+
+//without -iel:format, -iel:stream prints the records in the free text format
+//as soon as the loops are analysed, like the counts below
+void SIL::emitRecords(void)
+{
+    if (streamRecords && m_writer == NULL)
+    {
+        const std::vector<IELSectionRecord>& records = m_result.getRecords();
+        for (std::vector<IELSectionRecord>::const_iterator i = records.begin(); i != records.end(); ++i)
         {
-            currentParameter->setSILValue(False, SILParameter::Step1);
+            i->print(ielErr());
+        }
+    }
+}
+
+//perform step1 as per the paper for a single parameter and at the same time construct
+//its sets RD and CP
+template <typename Trace>
+void SIL::runStep1(IELSection* ielSection, SILParameterTable::Index i, ControlDependence& cd, Trace& trace)
+{
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+
+    silParameters.constructDefinitionList(i);
+
+    //the list is incomplete, the caller gives up on the loop
+    if (m_loopBudget.isExceeded() || m_functionBudget.isExceeded()) return;
+
+    bool isInside = false, isOutside = false;
+    unsigned int numDefinitions = silParameters.getNumDefinitions(i);
+
+    for (unsigned int j = 0; j < numDefinitions; ++j)
+    {
+        BasicBlock* parent = silParameters.getDefinitionParent(i, j);
+
+        if (ielSection->isInBody(parent))
+        {
+            silParameters.addRD(i, j);
+            isInside = true;
         }
         else
         {
-            currentParameter->setSILValue(DontKnow);
+            isOutside = true;
         }
     }
+
+    if (isInside && isOutside)
+    {
+        silParameters.setSILValue(i, False);
+        trace.rejected(i, SILParameterTable::Step1);
+    }
+    else
+    {
+        silParameters.setSILValue(i, DontKnow);
+
+        //CP only depends on the instruction of the parameter, so it is computed once
+        //here instead of on every iteration of step2
+        computeCP(ielSection, i, cd);
+    }
 }
 
-void SIL::computeCP(IELSection* ielSection, SILParameter* silParameter, ControlDependence& cd)
+//charge both the loop and the function budget, return false if either is used up
+bool SIL::chargeBudget(uint64_t units)
 {
-    assert(silParameter->getLoop() == ielSection->getLoop());
+    bool loopLeft = m_loopBudget.charge(units);
+    bool functionLeft = m_functionBudget.charge(units);
 
-    Loop* loop = silParameter->getLoop();
-    const std::vector<Instruction*>& deps = cd.getControlDependenceInstructions(silParameter->getInstruction());
+    return loopLeft && functionLeft;
+}
 
-    for (std::vector<Instruction*>::const_iterator j = deps.begin(); j != deps.end(); ++j)
+//perform step1 on every parameter of the loop
+//return false if the loop was found not to be an IE/L section
+template <typename Trace>
+bool SIL::runStep1(IELSection* ielSection, std::vector<SILParameterTable::Index>& parameters, Trace& trace)
+{
+    assert(ielSection != NULL);
+    ControlDependence& cd = *m_currentControlDependence;
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+
+    parameters.reserve(silParameters.size());
+    for (SILParameterTable::Index i = 0; i < silParameters.size(); ++i)
     {
-        BasicBlock* instructionParent = (*j)->getParent();
+        runStep1(ielSection, i, cd, trace);
+        parameters.push_back(i);
 
-        if (loop->contains(instructionParent) && loop->getHeader() != instructionParent)
+        if (!chargeBudget(1 + silParameters.getNumDefinitions(i)))
         {
-            silParameter->addCP(*j);
+            return false;
+        }
+
+        if (Trace::FailFast && ielSection->isCheckSite(i) && silParameters.getSILValue(i) == False)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//demand driven step1: start from the check sites of finalCheck and only visit the
+//parameters they transitively depend on through RD and CP. The parameters outside of
+//this backward slice cannot change the outcome of finalCheck, so they are never evaluated
+template <typename Trace>
+bool SIL::runStep1OnSlice(IELSection* ielSection, std::vector<SILParameterTable::Index>& parameters, Trace& trace)
+{
+    assert(ielSection != NULL);
+    ControlDependence& cd = *m_currentControlDependence;
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+    std::vector<bool> inSlice(silParameters.size(), false);
+
+    const std::vector<IELSection::CheckSite>& checkSites = ielSection->getCheckSites();
+    for (std::vector<IELSection::CheckSite>::const_iterator i = checkSites.begin(); i != checkSites.end(); ++i)
+    {
+        if (!inSlice[i->parameter])
+        {
+            inSlice[i->parameter] = true;
+            parameters.push_back(i->parameter);
+        }
+    }
+
+    //parameters doubles as the worklist, everything before next has been evaluated
+    for (unsigned int next = 0; next < parameters.size(); ++next)
+    {
+        SILParameterTable::Index i = parameters[next];
+        runStep1(ielSection, i, cd, trace);
+
+        if (!chargeBudget(1 + silParameters.getNumDefinitions(i)))
+        {
+            return false;
+        }
+
+        //a parameter that is False after step1 stays False whatever it depends on
+        if (silParameters.getSILValue(i) == DontKnow)
+        {
+            addDependencies(ielSection, i, inSlice, parameters);
+        }
+        else if (Trace::FailFast && ielSection->isCheckSite(i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//append to parameters the parameters that step2 reads when recomputing silParameter
+void SIL::addDependencies(IELSection* ielSection, SILParameterTable::Index silParameter, std::vector<bool>& inSlice, std::vector<SILParameterTable::Index>& parameters)
+{
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+
+    Span<unsigned int> rd = silParameters.getRD(silParameter);
+    for (Span<unsigned int>::iterator i = rd.begin(); i != rd.end(); ++i)
+    {
+        Instruction* inst = dyn_cast<Instruction>(silParameters.getDefinition(silParameter, *i));
+        if (inst == NULL) continue;
+
+        for (User::op_iterator j = inst->op_begin(); j != inst->op_end(); ++j)
+        {
+            if (isa<Constant>(*j) || !isa<Instruction>(*j) || isa<BasicBlock>(*j)) continue;
+
+            SILParameterTable::Index p = silParameters.lookup(*j);
+            if (p != SILParameterTable::NotFound && !inSlice[p])
+            {
+                inSlice[p] = true;
+                parameters.push_back(p);
+            }
+        }
+    }
+
+    Span<Instruction*> cp = silParameters.getCP(silParameter);
+    for (Span<Instruction*>::iterator i = cp.begin(); i != cp.end(); ++i)
+    {
+        for (User::op_iterator j = (*i)->op_begin(); j != (*i)->op_end(); ++j)
+        {
+            if (isa<Constant>(*j) || !isa<Instruction>(*j)) continue;
+
+            SILParameterTable::Index p = silParameters.lookup(*j);
+            if (p != SILParameterTable::NotFound && !inSlice[p])
+            {
+                inSlice[p] = true;
+                parameters.push_back(p);
+            }
+        }
+    }
+}
+
+void SIL::computeCP(IELSection* ielSection, SILParameterTable::Index silParameter, ControlDependence& cd)
+{
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+    BasicBlock* parent = silParameters.getInstruction(silParameter)->getParent();
+
+    for (std::vector<BasicBlock*>::const_iterator j = cd.dependence_begin(parent); j != cd.dependence_end(parent); ++j)
+    {
+        if (ielSection->isInBody(*j))
+        {
+            silParameters.addCP(silParameter, cd.getBranchInstruction(*j));
         }
     }
 }
 
-int g_iteration = 0;
 //return true if the SI/L value for this parameter changes from DontKnow to False
-bool SIL::recomputeSILValue(SILParameter* silParameter, IELSection* ielSection)
+template <typename Trace>
+bool SIL::recomputeSILValue(SILParameterTable::Index silParameter, IELSection* ielSection, Trace& trace)
 {
-    const std::vector<unsigned int>& rd = silParameter->getRD();
-    for (unsigned int i = 0; i < rd.size(); ++i)
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+
+    Span<unsigned int> rd = silParameters.getRD(silParameter);
+    for (Span<unsigned int>::iterator i = rd.begin(); i != rd.end(); ++i)
     {
         Instruction* inst;
-        if ((inst = dyn_cast<Instruction>(silParameter->getDefinition(i))) == NULL)
+        if ((inst = dyn_cast<Instruction>(silParameters.getDefinition(silParameter, *i))) == NULL)
         {
             continue;
         }
@@ -106,38 +351,28 @@ bool SIL::recomputeSILValue(SILParameter* silParameter, IELSection* ielSection)
         {
             if (isa<Constant>(*j) || !isa<Instruction>(*j) || isa<BasicBlock>(*j)) continue;
 
-            //this can never return NULL as all *j that are considered here are inside the loop 
-            //and we have constructed an SILParameter object for all variables used inside the loop
-            SILParameter* p = ielSection->getSILParameter(*j);
+            //this can never return NotFound as all *j that are considered here are inside the loop 
+            //and we have constructed a parameter for all variables used inside the loop
+            SILParameterTable::Index p = silParameters.lookup(*j);
 
-            if (p == NULL)
+            if (p == SILParameterTable::NotFound)
             { 
-		std::cout << "error: " << getLineNumber(inst) << std::endl;
-		inst->dump();
-		std::cout << std::endl;
-                j->get()->dump(); 
-                silParameter->getInstruction()->dump();
-                silParameter->getValue()->dump();
+                trace.missingParameter(inst, *j);
             }
 
-            assert(p != NULL);
+            assert(p != SILParameterTable::NotFound);
 
-            if (p->getSILValue() == False)
+            if (silParameters.getSILValue(p) == False)
             {
-                silParameter->setSILValue(False, SILParameter::Step2a, inst, p);
-                /*if (g_iteration == 0)
-                {
-                    silParameter->print();
-                    std::cerr << std::endl;
-                }
-                */
+                silParameters.setSILValue(silParameter, False);
+                trace.rejected(silParameter, SILParameterTable::Step2a, inst, p);
                 return true;
             }
         }
     }
 
-    const std::vector<Instruction*>& cp = silParameter->getCP();
-    for (std::vector<Instruction*>::const_iterator i = cp.begin(); i != cp.end(); ++i)
+    Span<Instruction*> cp = silParameters.getCP(silParameter);
+    for (Span<Instruction*>::iterator i = cp.begin(); i != cp.end(); ++i)
     {
         for (User::op_iterator j = (*i)->op_begin(); j != (*i)->op_end(); ++j)
         {
@@ -145,33 +380,21 @@ bool SIL::recomputeSILValue(SILParameter* silParameter, IELSection* ielSection)
             if (isa<Constant>(*j) || !isa<Instruction>(*j))
                 continue;
 
-            //this can never return NULL as all *j that are considered here are inside the loop
-            //and we have constructed an SILParameter object for all variables used inside the loop
-            SILParameter* p = ielSection->getSILParameter(*j);
+            //this can never return NotFound as all *j that are considered here are inside the loop
+            //and we have constructed a parameter for all variables used inside the loop
+            SILParameterTable::Index p = silParameters.lookup(*j);
  
-            if (p == NULL)
+            if (p == SILParameterTable::NotFound)
             { 
-		std::cout << "error: cp: \n";
-		(*i)->dump();
-		std::cout << std::endl;
-                j->get()->dump(); 
-                silParameter->getInstruction()->dump();
-                silParameter->getValue()->dump();
+                trace.missingParameter(*i, *j);
             }
 
+            assert(p != SILParameterTable::NotFound);
 
-            assert(p != NULL);
-
-            if (p->getSILValue() == False)
+            if (silParameters.getSILValue(p) == False)
             {
-                silParameter->setSILValue(False, SILParameter::Step2b, *i, p);
-                /*
-                if (g_iteration == 0)
-                {
-                    silParameter->print();
-                    std::cerr << std::endl;
-                }
-                */
+                silParameters.setSILValue(silParameter, False);
+                trace.rejected(silParameter, SILParameterTable::Step2b, *i, p);
                 return true;
             }
         }
@@ -180,50 +403,52 @@ bool SIL::recomputeSILValue(SILParameter* silParameter, IELSection* ielSection)
     return false;
 }
 
-void SIL::runStep2(IELSection* ielSection)
+//return false if the loop was found not to be an IE/L section
+template <typename Trace>
+bool SIL::runStep2(IELSection* ielSection, const std::vector<SILParameterTable::Index>& parameters, Trace& trace)
 {
-    ControlDependence& cd = getAnalysis<ControlDependence>();
-
-    SILParameterList& silParameters = ielSection->getSILParameters();
+    SILParameterTable& silParameters = ielSection->getSILParameters();
     int changed = 0;
-    int iteration = 0;
 
     do
     {
         changed = 0;
 
-        for (SILParameterList::iterator i = silParameters.begin(); i != silParameters.end(); ++i)
+        for (std::vector<SILParameterTable::Index>::const_iterator i = parameters.begin(); i != parameters.end(); ++i)
         {
-            SILParameter* currentParameter = *i;
-
-            if (currentParameter->getSILValue() == DontKnow)
+            if (silParameters.getSILValue(*i) == DontKnow)
             {
-                //TODO: can be made faster by storing the control dependences on an instruction basis than storing it in SILParameter
-                //otherwise we will end up computing CPs multiple times
+                if (!chargeBudget(1))
+                {
+                    return false;
+                }
 
-                computeCP(ielSection, currentParameter, cd);
-                if (recomputeSILValue(currentParameter, ielSection))
+                if (recomputeSILValue(*i, ielSection, trace))
                 {
+                    if (Trace::FailFast && ielSection->isCheckSite(*i))
+                    {
+                        return false;
+                    }
+
                     ++changed;
                 }
             }
         }
 
-        ++iteration;
-        g_iteration = iteration;
-
     } while (changed != 0);
+
+    return true;
 }
 
-void SIL::runStep3(IELSection* ielSection)
+void SIL::runStep3(IELSection* ielSection, const std::vector<SILParameterTable::Index>& parameters)
 {
-    SILParameterList& silParameters = ielSection->getSILParameters();
+    SILParameterTable& silParameters = ielSection->getSILParameters();
 
-    for (SILParameterList::iterator i = silParameters.begin(); i != silParameters.end(); ++i)
+    for (std::vector<SILParameterTable::Index>::const_iterator i = parameters.begin(); i != parameters.end(); ++i)
     {
-        if ((*i)->getSILValue() == DontKnow)
+        if (silParameters.getSILValue(*i) == DontKnow)
         {
-            (*i)->setSILValue(True);
+            silParameters.setSILValue(*i, True);
         }
     }
 }
@@ -233,22 +458,21 @@ IELSection* SIL::createIELSection(Loop* loop)
 {
     assert (loop->getHeader() == *loop->block_begin() && "First node is not the header!");
 
-    IELSection* currentIELSection = new IELSection(loop, getId());
-    std::map<Value*, int> opcount;
+    IELSection* currentIELSection = new IELSection(loop, m_loopMembership.getBlockSet(loop), &m_definitionCache, &m_debugLocs, getId());
+
+    const InstructionIndex& instructionIndex = m_currentReachingDef->getInstructionIndex();
 
     bool foundInstructionsInBody = false;
     //skip the header of the loop
     for (LoopBase<BasicBlock, Loop>::block_iterator block = loop->block_begin() + 1; block != loop->block_end(); ++block)
     {
         currentIELSection->addBlock(*block);
-        for (BasicBlock::iterator instr = (*block)->begin(); instr != (*block)->end(); ++instr)
-        {
-            if (isa<PHINode>(instr)) //don't analyze the phi instruction by itself unless it is used in another instruction
-            {
-                continue;
-            }
 
-            for (User::op_iterator def = instr->op_begin(); def != instr->op_end(); ++def)
+        //don't analyze the phi instructions by themselves unless they are used in another instruction
+        Span<Instruction*> users = instructionIndex.getUsers(*block);
+        for (Span<Instruction*>::iterator instr = users.begin(); instr != users.end(); ++instr)
+        {
+            for (User::op_iterator def = (*instr)->op_begin(); def != (*instr)->op_end(); ++def)
             {
                 Value* v = def->get();
 
@@ -262,8 +486,7 @@ IELSection* SIL::createIELSection(Loop* loop)
                 }
 
                 foundInstructionsInBody = true;
-                SILParameter* silParameter = new SILParameter(loop, v, instr);
-                currentIELSection->addSILParameter(silParameter);
+                currentIELSection->addSILParameter(v, *instr);
             }
         }
     }
@@ -277,130 +500,84 @@ IELSection* SIL::createIELSection(Loop* loop)
     return currentIELSection;
 }
 
-bool SIL::finalCheck(IELSection* ielSection)
+//find the parameters whose SI/L value decides whether the loop is an IE/L section:
+//array indices of loads and conditions of branches in the body of the loop
+template <typename Trace>
+void SIL::collectCheckSites(IELSection* ielSection, Trace& trace)
 {
-    bool isIELSection = true;
-    std::vector<BasicBlock*> blocks = ielSection->getBlocks();
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+    const std::vector<BasicBlock*>& blocks = ielSection->getBlocks();
+    const InstructionIndex& instructionIndex = m_currentReachingDef->getInstructionIndex();
 
-    for (std::vector<BasicBlock*>::iterator block = blocks.begin(); block != blocks.end() && isIELSection; ++block)
+    for (std::vector<BasicBlock*>::const_iterator block = blocks.begin(); block != blocks.end(); ++block)
     {
-        for (BasicBlock::iterator instr = (*block)->begin(); instr != (*block)->end() && isIELSection; ++instr)
+        Span<InstructionIndex::LoadEntry> loads = instructionIndex.getLoads(*block);
+        for (Span<InstructionIndex::LoadEntry>::iterator load = loads.begin(); load != loads.end(); ++load)
         {
-            if (LoadInst *loadInst = dyn_cast<LoadInst>(instr))
+            Span<Value*> indices = instructionIndex.getIndices(*load);
+            for (Span<Value*>::iterator index = indices.begin(); index != indices.end(); ++index)
             {
-                Value* coreOperand;
-                std::set<Value*> indices = findCoreOperand(loadInst->getPointerOperand(), &coreOperand);
-                for (std::set<Value*>::iterator index = indices.begin(); index != indices.end(); ++index)
-                {
-                    if (isa<Constant>(*index) || !isa<Instruction>(*index)) continue;
-                    SILParameter* parameter = ielSection->getSILParameter(*index);
+                Instruction* indexInstruction = dyn_cast<Instruction>(*index);
+                if (indexInstruction == NULL) continue;
 
-                    if (Instruction *indexInstruction = dyn_cast<Instruction>(*index))
-                    {
-                        std::vector<BasicBlock*>::iterator where = std::find(blocks.begin(), blocks.end(), indexInstruction->getParent());
-                        if (where == blocks.end())
-                        {
-                            //TODO:this means that the definition for this index is outside of the loop and its use is also outside the loop
-                            //assert(parameter == NULL);
-                            continue;
-                        }
-                    }
-
-                    if (parameter == NULL)
-                    { 
-                        std::cout << "error: " << getLineNumber(instr) << std::endl;
-                        (instr)->dump();
-                        std::cout << instr->getParent()->getName().str() << std::endl;
-                        std::cout << std::endl;
-                        (*index)->dump(); 
-                    }
+                if (!ielSection->isInBody(indexInstruction->getParent()))
+                {
+                    //TODO:this means that the definition for this index is outside of the loop and its use is also outside the loop
+                    continue;
+                }
 
-                    assert(parameter != NULL);
+                SILParameterTable::Index parameter = silParameters.lookup(*index);
 
-                    if (parameter->getSILValue() == False)
-                    {
-                        isIELSection = false;
-                        if (printRejected)
-                        {
-                            std::cerr << "Array index" << std::endl;
-                            parameter->print();
-                            std::cerr << std::endl;
-                        }
-                        //parameter->printSILValue();
-                    }
+                if (parameter == SILParameterTable::NotFound)
+                { 
+                    trace.missingParameter(load->load, *index);
                 }
+
+                assert(parameter != SILParameterTable::NotFound);
+                ielSection->addCheckSite(parameter, IELSection::CheckSite::ArrayIndex);
             }
-            else if (BranchInst* branchInst = dyn_cast<BranchInst>(instr))
+        }
+
+        if (BranchInst* branchInst = instructionIndex.getConditionalBranch(*block))
+        {
+            if (Instruction* condition = dyn_cast<Instruction>(branchInst->getCondition()))
             {
-                if (branchInst->isConditional())
+                SILParameterTable::Index parameter = silParameters.lookup(condition);
+                
+                if (parameter == SILParameterTable::NotFound)
                 {
-                    if (Instruction* condition = dyn_cast<Instruction>(branchInst->getCondition()))
-                    {
-#if 0    
-                        for (User::op_iterator j = condition->op_begin(); j != condition->op_end(); ++j)
-                        {
-                            if (isa<Constant>(*j) || !isa<Instruction>(*j)) continue;
-
-                            SILParameter* parameter = ielSection->getSILParameter(*j);
-
-                            if (parameter == NULL)
-                            {
-                                std::cout << "error: " << getLineNumber(instr) << std::endl;
-                                (instr)->dump();
-                                std::cout << instr->getParent()->getName().str() << std::endl;
-                                std::cout << std::endl;
-                                (*j)->dump();
-                                std::cout << getLineNumber(condition) << std::endl;
-                                condition->dump();
-                            }
-
-                            assert(parameter != NULL);
-                            if (parameter->getSILValue() == False)
-                            {
-                                if (printRejected)
-                                {
-                                    std::cerr << "Branch\n";
-                                    parameter->print();
-                                    std::cerr << std::endl;
-                                }
-                                isIELSection = false;
-                            }
-                        }
-#else                        
-                        if (isa<Constant>(condition)) continue;
-                        SILParameter* parameter = ielSection->getSILParameter(condition);
-                        
-                        if (parameter == NULL)
-                        {
-                            std::cout << "error: " << getLineNumber(instr) << std::endl;
-                            (instr)->dump();
-                            std::cout << instr->getParent()->getName().str() << std::endl;
-                            std::cout << getLineNumber(condition) << std::endl;
-                            condition->dump();
-                        }
-
-                        assert(parameter != NULL);
-                        if (parameter->getSILValue() == False)
-                        {
-                            if (printRejected)
-                            {
-                                std::cerr << "Branch\n";
-                                parameter->print();
-                                std::cerr << std::endl;
-                            }
-                            isIELSection = false;
-                        }
-#endif                        
-                    }
-                    else
-                    {
-			std::cout << "condition ";
-			branchInst->getCondition()->dump();
-			std::cout << " is not an instruction\n";
-                        assert(false);
-                    }
+                    trace.missingParameter(branchInst, condition);
                 }
+
+                assert(parameter != SILParameterTable::NotFound);
+                ielSection->addCheckSite(parameter, IELSection::CheckSite::Branch);
             }
+            else
+            {
+		ielOut() << "condition ";
+		dumpValue(branchInst->getCondition());
+		ielOut() << " is not an instruction\n";
+                assert(false);
+            }
+        }
+    }
+}
+
+template <typename Trace>
+bool SIL::finalCheck(IELSection* ielSection, Trace& trace)
+{
+    bool isIELSection = true;
+    SILParameterTable& silParameters = ielSection->getSILParameters();
+    const std::vector<IELSection::CheckSite>& checkSites = ielSection->getCheckSites();
+
+    //-iel:print-rejected alone reports the first rejected check site as it always did,
+    //-iel:explain reports every one of them
+    for (std::vector<IELSection::CheckSite>::const_iterator i = checkSites.begin(); i != checkSites.end() && (isIELSection || (!Trace::FailFast && explain)); ++i)
+    {
+        if (silParameters.getSILValue(i->parameter) == False)
+        {
+            isIELSection = false;
+            trace.rejectedCheckSite(*i);
         }
     }
 
@@ -442,7 +619,9 @@ void SIL::checkOuterLoops(Loop* loop)
     IELSection* ielSection = checkLoop(loop);
     if (ielSection == NULL)
     {
-        const std::vector<Loop*>& subLoops = loop->getSubLoops();
+        std::vector<Loop*> subLoops = loop->getSubLoops();
+        orderByHotness(subLoops);
+
         for (std::vector<Loop*>::const_iterator i = subLoops.begin(); i != subLoops.end(); ++i)
         {
             checkOuterLoops(*i);
@@ -459,22 +638,162 @@ void SIL::checkOuterLoops(Loop* loop)
     }
 }
 
+void SIL::reportBudgetExceeded(Loop* loop, unsigned int numParameters, unsigned int numCheckSites, uint64_t microseconds)
+{
+    ++m_counts.budgetExceeded;
+    m_loops.push_back(loop);
+
+    IELSectionRecord record(loop, m_debugLocs, IELSectionRecord::BudgetExceeded, numParameters, numCheckSites);
+    record.microseconds = microseconds;
+    m_result.add(loop, record);
+
+    if (m_writer != NULL) return;
+
+    ielErr() << "Line no: " << record.firstLine << std::endl;
+    ielErr() << "Loop header: " << loop->getHeader()->getName().str() << std::endl;
+    ielErr() << "Function: " << loop->getHeader()->getParent()->getName().str() << std::endl;
+    ielErr() << "not an IE/L section (budget exceeded)" << std::endl;
+    ielErr() << std::endl;
+}
+
+bool SIL::isCold(Loop* loop)
+{
+    return m_profile.isLoaded() && m_profile.getCount(loop) < coldCount;
+}
+
+void SIL::reportCold(Loop* loop)
+{
+    ++m_counts.cold;
+    m_loops.push_back(loop);
+    m_result.add(loop, IELSectionRecord(loop, m_debugLocs, IELSectionRecord::Cold, 0, 0));
+}
+
+void SIL::startLoopBudget(Loop* loop)
+{
+    if (m_profile.isLoaded() && m_profile.getCount(loop) >= hotCount)
+    {
+        m_loopBudget.start((uint64_t)loopBudget * hotBudgetScale, (uint64_t)loopTimeBudget * hotBudgetScale);
+    }
+    else
+    {
+        m_loopBudget.start(loopBudget, loopTimeBudget);
+    }
+}
+
+//stable, so loops with the same count keep their layout order
+void SIL::orderByHotness(std::vector<Loop*>& loops)
+{
+    if (!m_profile.isLoaded()) return;
+
+    std::vector<std::pair<uint64_t, Loop*> > counts;
+    for (std::vector<Loop*>::iterator i = loops.begin(); i != loops.end(); ++i)
+    {
+        counts.push_back(std::make_pair(m_profile.getCount(*i), *i));
+    }
+
+    std::stable_sort(counts.begin(), counts.end(), HotterThan());
+
+    for (unsigned int i = 0; i < loops.size(); ++i)
+    {
+        loops[i] = counts[i].second;
+    }
+}
+
+IELSection* SIL::checkLoop(Loop* loop)
+{
+    if (isReusable(loop))
+    {
+        return reuseLoop(loop);
+    }
+
+    if (isCold(loop))
+    {
+        reportCold(loop);
+        return NULL;
+    }
+
+    if (explain || printRejected)
+    {
+        return checkLoop<ExplainTrace>(loop);
+    }
+
+    return checkLoop<NoTrace>(loop);
+}
+
+template <typename Trace>
 IELSection* SIL::checkLoop(Loop* loop)
 {
+    //once the function budget is used up the remaining loops are not analysed at all
+    if (m_functionBudget.isExceeded())
+    {
+        reportBudgetExceeded(loop, 0, 0, 0);
+        return NULL;
+    }
+
+    sys::TimeValue start = sys::TimeValue::now();
     IELSection* ielSection = createIELSection(loop);
     if (ielSection == NULL) return NULL;
 
-    runStep1(ielSection);
-    runStep2(ielSection);
-    runStep3(ielSection);
+    startLoopBudget(loop);
+    Trace trace(ielSection);
+
+    collectCheckSites(ielSection, trace);
+
+    //the parameters steps 2 and 3 have to look at
+    std::vector<SILParameterTable::Index> parameters;
+    bool mayBeIELSection;
 
-    finalCheck(ielSection);
+    if (demandDriven)
+    {
+        mayBeIELSection = runStep1OnSlice(ielSection, parameters, trace);
+    }
+    else
+    {
+        mayBeIELSection = runStep1(ielSection, parameters, trace);
+    }
+
+    //with a fail fast trace the steps return as soon as a check site becomes False
+    IELSectionRecord::RejectionStep rejectionStep = IELSectionRecord::RejectedInFinalCheck;
+    if (!mayBeIELSection)
+    {
+        rejectionStep = IELSectionRecord::RejectedInStep1;
+    }
+    else if (!runStep2(ielSection, parameters, trace))
+    {
+        rejectionStep = IELSectionRecord::RejectedInStep2;
+    }
+    else
+    {
+        runStep3(ielSection, parameters);
+        finalCheck(ielSection, trace);
+    }
+
+    uint64_t microseconds = (sys::TimeValue::now() - start).usec();
+
+    if (rejectionStep != IELSectionRecord::RejectedInFinalCheck && (m_loopBudget.isExceeded() || m_functionBudget.isExceeded()))
+    {
+        //the SI/L values are incomplete, so conservatively reject the loop
+        reportBudgetExceeded(loop, ielSection->size(), ielSection->getCheckSites().size(), microseconds);
+        delete ielSection;
+        return NULL;
+    }
+
+    IELSectionRecord::Verdict verdict = ielSection->isIELSection() ? IELSectionRecord::Accepted : IELSectionRecord::Rejected;
+    IELSectionRecord record(loop, m_debugLocs, verdict, ielSection->size(), ielSection->getCheckSites().size());
+    record.rejectionStep = ielSection->isIELSection() ? IELSectionRecord::NotRejected : rejectionStep;
+    record.microseconds = microseconds;
+
+    m_loops.push_back(loop);
+    m_result.add(loop, record);
 
     if (ielSection->isIELSection())
     {
         ++m_counts.afterFinalCheck;
         m_ielSections.push_back(ielSection);
-        ielSection->printIELSection();
+        if (m_writer == NULL)
+        {
+            ielSection->printIELSection(record);
+        }
         return ielSection;
     }
 
@@ -482,12 +801,400 @@ IELSection* SIL::checkLoop(Loop* loop)
     return NULL;
 }
 
+//a loop that update does not have to analyse again: it existed before the
+//transformation, none of its blocks is affected, and it was not stopped by a budget
+bool SIL::isReusable(Loop* loop)
+{
+    if (m_reusableRecords.empty()) return false;
+
+    DenseMap<BasicBlock*, IELSectionRecord>::iterator where = m_reusableRecords.find(loop->getHeader());
+    if (where == m_reusableRecords.end() || where->second.verdict == IELSectionRecord::BudgetExceeded)
+    {
+        return false;
+    }
+
+    for (LoopBase<BasicBlock, Loop>::block_iterator i = loop->block_begin(); i != loop->block_end(); ++i)
+    {
+        if (m_affectedBlocks.test(m_currentNumbering->getBlockNumber(*i)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+IELSection* SIL::reuseLoop(Loop* loop)
+{
+    BasicBlock* header = loop->getHeader();
+
+    m_loops.push_back(loop);
+    m_result.add(loop, m_reusableRecords[header]);
+
+    DenseMap<BasicBlock*, IELSection*>::iterator where = m_reusableSections.find(header);
+    if (where == m_reusableSections.end())
+    {
+        return NULL;
+    }
+
+    IELSection* ielSection = where->second;
+    m_reusableSections.erase(where);
+
+    ielSection->rebind(loop, m_loopMembership.getBlockSet(loop));
+    ++m_counts.afterFinalCheck;
+    m_ielSections.push_back(ielSection);
+    return ielSection;
+}
+
+bool SIL::doInitialization(Module& module)
+{
+    if (m_writer == NULL && outputFormat != ResultWriter::None)
+    {
+        m_writer = ResultWriter::create(outputFormat);
+        m_writer->begin(ielOut());
+    }
+
+    if (!cacheDirectory.empty() && !m_cache.isEnabled())
+    {
+        std::string error;
+        if (sys::Path(cacheDirectory).createDirectoryOnDisk(true, &error))
+        {
+            ielErr() << "iel: " << error << ", analysing without a cache" << std::endl;
+        }
+        else
+        {
+            m_cache.setDirectory(cacheDirectory);
+        }
+    }
+
+    if (!profileFile.empty() && !m_profile.isLoaded())
+    {
+        std::string error;
+        if (!m_profile.load(profileFile, error))
+        {
+            ielErr() << "iel: " << error << ", analysing loops without a profile" << std::endl;
+        }
+    }
+
+    return false;
+}
+
+//in -iel:stream mode the records are gone already
+bool SIL::doFinalization(Module& module)
+{
+    std::string error;
+    if (!databaseFile.empty() && !streamRecords && !ResultDatabase::write(databaseFile, m_result.getRecords(), error))
+    {
+        ielErr() << "iel: " << error << std::endl;
+    }
+
+    return false;
+}
+
 bool SIL::runOnFunction(Function& function)
 {
     m_currentReachingDef = &getAnalysis<ReachingDef>();
-    LoopInfo& loopInfo = getAnalysis<LoopInfo>();
+    m_currentControlDependence = &getAnalysis<ControlDependence>();
+    m_currentNumbering = &getAnalysis<ValueNumbering>();
+    m_currentLoopInfo = &getAnalysis<LoopInfo>();
+
+    analyzeFunction(function);
+    
+    return false;
+}
+
+//return true if function has a loop that createIELSection would not drop right away.
+//With -iel:skip-empty-body-loops that is a loop with an instruction outside its
+//header that uses another instruction
+bool SIL::hasCandidateLoop(Function& function)
+{
+    LoopInfo& loopInfo = *m_currentLoopInfo;
+    if (loopInfo.begin() == loopInfo.end()) return false;
+    if (!skipEmptyBodyLoops) return true;
+
+    for (Function::iterator block = function.begin(); block != function.end(); ++block)
+    {
+        Loop* loop = loopInfo.getLoopFor(block);
+        if (loop == NULL) continue;
+
+        //the header of an inner loop is in the body of the outer loops
+        if (loop->getHeader() == block && loop->getParentLoop() == NULL) continue;
+
+        for (BasicBlock::iterator instr = block->getFirstNonPHI(); instr != block->end(); ++instr)
+        {
+            for (User::op_iterator use = instr->op_begin(); use != instr->op_end(); ++use)
+            {
+                if (isa<Instruction>(use->get())) return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void* computeReachingDef(void* reachingDef)
+{
+    static_cast<ReachingDef*>(reachingDef)->compute();
+    return NULL;
+}
+
+//ReachingDef and ControlDependence only read the IR and the numbering, so unless
+//-iel:threads is 1 the reaching definitions are computed on a second thread
+//return false if the function budget does not cover the reaching definitions and
+//control dependences
+bool SIL::chargePrerequisites(void)
+{
+    return m_functionBudget.charge(m_currentNumbering->getNumInstructions() + m_currentNumbering->getNumBlocks());
+}
+
+void SIL::computePrerequisites(void)
+{
+    pthread_t thread;
+    bool isConcurrent = silThreads != 1 && pthread_create(&thread, NULL, computeReachingDef, m_currentReachingDef) == 0;
+
+    if (!isConcurrent)
+    {
+        m_currentReachingDef->compute();
+    }
+
+    m_currentControlDependence->compute();
 
-    std::string functionName = function.getName().str();
+    if (isConcurrent)
+    {
+        pthread_join(thread, NULL);
+    }
+}
+
+void SIL::analyzeFunction(Function& function, ValueNumbering& numbering, ReachingDef& reachingDef, ControlDependence& controlDependence, LoopInfo& loopInfo)
+{
+    m_currentReachingDef = &reachingDef;
+    m_currentControlDependence = &controlDependence;
+    m_currentNumbering = &numbering;
+    m_currentLoopInfo = &loopInfo;
+
+    analyzeFunction(function);
+}
+
+void SIL::takeRecords(std::vector<IELSectionRecord>& records)
+{
+    records = m_result.getRecords();
+    m_result.clear();
+}
+
+//the reaching definitions and control dependences are only computed once function
+//is known to have a loop to analyse, most functions are small helpers without one
+void SIL::analyzeFunction(Function& function)
+{
+    releaseSections();
+    m_result.beginFunction();
+    m_counts = Counts();
+    m_histogram.clear();
+
+    analyzeOrReplay(function);
+    writeRecords(function);
+}
+
+void SIL::analyzeOrReplay(Function& function)
+{
+    if (!hasCandidateLoop(function))
+    {
+        //the loops would all be skipped, but they are still counted
+        for (Function::iterator block = function.begin(); block != function.end(); ++block)
+        {
+            Loop* loop = m_currentLoopInfo->getLoopFor(block);
+            if (loop != NULL && loop->getHeader() == block)
+            {
+                ++m_counts.totalLoops;
+            }
+        }
+
+        printCounts();
+        return;
+    }
+
+    //time budgets make the result depend on the machine, so it is not cached
+    bool useCache = m_cache.isEnabled() && loopTimeBudget == 0 && functionTimeBudget == 0;
+    uint64_t key = 0;
+    ResultCache::Entry entry;
+
+    if (useCache)
+    {
+        key = ResultCache::getKey(function, m_currentReachingDef->getModRef(), getCacheOptions(function));
+        if (m_cache.lookup(key, entry))
+        {
+            replayEntry(function, entry);
+            return;
+        }
+    }
+
+    //the output is captured for the cache and then passed on
+    std::ostream& out = ielOut();
+    std::ostream& err = ielErr();
+    std::ostringstream capturedOut;
+    std::ostringstream capturedErr;
+
+    if (useCache)
+    {
+        redirectOutput(&capturedOut, &capturedErr);
+    }
+
+    //the function budget covers the reaching definitions and control dependences as
+    //well. They are charged one unit per instruction and block up front and are not
+    //computed at all if that is more than the budget, the loops are then reported as
+    //over budget without being looked at
+    m_functionBudget.start(functionBudget, functionTimeBudget);
+    if (chargePrerequisites())
+    {
+        computePrerequisites();
+        m_functionBudget.checkTime();
+    }
+
+    m_loopMembership.build(*m_currentLoopInfo, *m_currentNumbering);
+    m_debugLocs.build(*m_currentLoopInfo, *m_currentNumbering);
+    m_definitionCache.reset(m_currentReachingDef);
+
+    analyzeLoops(function);
+
+    if (useCache)
+    {
+        redirectOutput(&out, &err);
+
+        entry.out = capturedOut.str();
+        entry.err = capturedErr.str();
+        m_result.getFunctionRecords(entry.records);
+        entry.counts.totalLoops = m_counts.totalLoops;
+        entry.counts.afterFinalCheck = m_counts.afterFinalCheck;
+        entry.counts.budgetExceeded = m_counts.budgetExceeded;
+        entry.counts.cold = m_counts.cold;
+        entry.counts.histogram = m_histogram;
+        m_cache.store(key, entry);
+
+        out << entry.out;
+        err << entry.err;
+    }
+}
+
+//every option that changes what SIL finds or prints for function, see ResultCache. The
+//writer runs after the output is captured, so only whether there is one matters: it
+//replaces the free text reports
+std::string SIL::getCacheOptions(Function& function)
+{
+    std::ostringstream options;
+    options << (bool)outerLoops << (bool)skipEmptyBodyLoops << (bool)explain << (bool)printRejected
+            << (bool)printCount << (bool)streamRecords << (bool)demandDriven << (outputFormat != ResultWriter::None)
+            << " " << (unsigned)loopBudget << " " << (unsigned)functionBudget;
+
+    if (m_profile.isLoaded())
+    {
+        options << " " << (unsigned)hotCount << " " << (unsigned)hotBudgetScale << " " << (unsigned)coldCount;
+
+        for (Function::iterator block = function.begin(); block != function.end(); ++block)
+        {
+            Loop* loop = m_currentLoopInfo->getLoopFor(block);
+            if (loop != NULL && loop->getHeader() == block)
+            {
+                options << " " << m_profile.getCount(loop);
+            }
+        }
+    }
+
+    return options.str();
+}
+
+//print what the analysis printed when the entry was stored, and restore its records,
+//counts and analysed loops as if the function had been analysed. Only the sections
+//are missing, they were never computed. The time of the run that stored the records
+//says nothing about this one, so it is cleared
+void SIL::replayEntry(Function& function, const ResultCache::Entry& entry)
+{
+    ielOut() << entry.out;
+    ielErr() << entry.err;
+
+    m_counts.totalLoops = entry.counts.totalLoops;
+    m_counts.afterFinalCheck = entry.counts.afterFinalCheck;
+    m_counts.budgetExceeded = entry.counts.budgetExceeded;
+    m_counts.cold = entry.counts.cold;
+    m_histogram = entry.counts.histogram;
+
+    StringMap<Loop*> loops;
+    for (Function::iterator block = function.begin(); block != function.end(); ++block)
+    {
+        Loop* loop = m_currentLoopInfo->getLoopFor(block);
+        if (loop != NULL && loop->getHeader() == block)
+        {
+            loops[block->getName()] = loop;
+        }
+    }
+
+    for (std::vector<IELSectionRecord>::const_iterator i = entry.records.begin(); i != entry.records.end(); ++i)
+    {
+        IELSectionRecord record = *i;
+        record.microseconds = 0;
+
+        StringMap<Loop*>::iterator where = loops.find(record.header);
+        if (where != loops.end())
+        {
+            m_loops.push_back(where->second);
+            m_result.add(where->second, record);
+        }
+        else
+        {
+            m_result.add(record);
+        }
+    }
+}
+
+void SIL::update(Function& function, const std::vector<BasicBlock*>& changedBlocks)
+{
+    assert(m_currentReachingDef != NULL && m_currentReachingDef->getCurrentFunction() == &function);
+
+    m_currentNumbering->renumber(function);
+
+    //nothing was analysed before, so there is nothing to update or reuse
+    if (!m_currentReachingDef->isComputed())
+    {
+        analyzeFunction(function);
+        return;
+    }
+
+    //charged like a fresh analysis so that both come to the same result, but the
+    //update is always done, the dependences of the next update are built on it
+    m_functionBudget.start(functionBudget, functionTimeBudget);
+    chargePrerequisites();
+
+    m_affectedBlocks.clear();
+    m_affectedBlocks.resize(m_currentNumbering->getNumBlocks());
+    m_currentReachingDef->update(function, changedBlocks, m_affectedBlocks);
+    m_currentControlDependence->update(function, m_affectedBlocks);
+    m_functionBudget.checkTime();
+
+    //the accepted sections are handed back by reuseLoop, the others were deleted already
+    for (std::vector<IELSection*>::iterator i = m_ielSections.begin(); i != m_ielSections.end(); ++i)
+    {
+        m_reusableSections[(*i)->getHeader()] = *i;
+    }
+    m_ielSections.clear();
+    m_loops.clear();
+    m_result.removeFunction(m_reusableRecords);
+
+    m_loopMembership.build(*m_currentLoopInfo, *m_currentNumbering);
+    m_debugLocs.build(*m_currentLoopInfo, *m_currentNumbering);
+    m_definitionCache.invalidate();
+
+    analyzeLoops(function);
+    writeRecords(function);
+
+    for (DenseMap<BasicBlock*, IELSection*>::iterator i = m_reusableSections.begin(); i != m_reusableSections.end(); ++i)
+    {
+        delete i->second;
+    }
+    m_reusableSections.clear();
+    m_reusableRecords.clear();
+}
+
+void SIL::analyzeLoops(Function& function)
+{
+    LoopInfo& loopInfo = *m_currentLoopInfo;
 
     m_counts = Counts();
     m_histogram.clear();
@@ -496,7 +1203,10 @@ bool SIL::runOnFunction(Function& function)
 
     if (outerLoops)
     {
-        for (LoopInfo::iterator i = loopInfo.begin(); i != loopInfo.end(); ++i)
+        std::vector<Loop*> loops(loopInfo.begin(), loopInfo.end());
+        orderByHotness(loops);
+
+        for (std::vector<Loop*>::iterator i = loops.begin(); i != loops.end(); ++i)
         {
             Loop* loop = *i;
             checkOuterLoops(loop);
@@ -505,6 +1215,7 @@ bool SIL::runOnFunction(Function& function)
     else
     {
         std::vector<BasicBlock*> headers;
+        std::vector<Loop*> loops;
         std::map<Loop*, bool> visited;
 
         for (Function::iterator i = function.begin(); i != function.end(); ++i)
@@ -520,27 +1231,44 @@ bool SIL::runOnFunction(Function& function)
             }
 
             headers.push_back(loop->getHeader());
-            assert(m_currentReachingDef->getCurrentFunction() == loop->getHeader()->getParent());
-            checkLoop(loop);
+            loops.push_back(loop);
+        }
+
+        orderByHotness(loops);
+
+        for (std::vector<Loop*>::iterator i = loops.begin(); i != loops.end(); ++i)
+        {
+            assert(m_currentReachingDef->getCurrentFunction() == (*i)->getHeader()->getParent());
+            checkLoop(*i);
         }
 
         m_counts.totalLoops = visited.size();
     }
 
-    if (printCount)
+    emitRecords();
+    printCounts();
+}
+
+//the free text counts of -iel:print-counts, the writer has its own
+void SIL::printCounts(void)
+{
+    if (printCount && m_writer == NULL)
     {
         if (m_counts.totalLoops != 0)
         {
-            std::cerr << "Loop count: " << m_counts.totalLoops << std::endl;
-            std::cerr << "After final check: " << m_counts.afterFinalCheck << std::endl;
+            ielErr() << "Loop count: " << m_counts.totalLoops << std::endl;
+            ielErr() << "After final check: " << m_counts.afterFinalCheck << std::endl;
+            ielErr() << "Budget exceeded: " << m_counts.budgetExceeded << std::endl;
+            if (m_profile.isLoaded())
+            {
+                ielErr() << "Cold: " << m_counts.cold << std::endl;
+            }
             for (unsigned int i = 1; i < m_histogram.size(); ++i)
             {
-                std::cerr << "Loop depth: " << i << " " << m_histogram[i] << std::endl;
+                ielErr() << "Loop depth: " << i << " " << m_histogram[i] << std::endl;
             }
         }
     }
-    
-    return false;
 }
 
 /*
@@ -646,21 +1374,20 @@ bool SIL::isAncestor(Loop* dstLoop, Loop* srcLoop)
 
 void SIL::dump(void)
 {
-    std::cout << "Found " << m_ielSections.size() << " IE/L-section" << (m_ielSections.size() > 1 ? "s\n": "\n");
+    ielOut() << "Found " << m_ielSections.size() << " IE/L-section" << (m_ielSections.size() > 1 ? "s\n": "\n");
     for (std::vector<IELSection*>::iterator i = m_ielSections.begin(); i != m_ielSections.end(); ++i)
     {
         Loop* loop = (*i)->getLoop();
-        std::cerr << "Loop header: " << loop->getHeader()->getName().str() << "\n\n";
+        ielErr() << "Loop header: " << loop->getHeader()->getName().str() << "\n\n";
         
-        SILParameterList& parList = (*i)->getSILParameters();
+        SILParameterTable& parameters = (*i)->getSILParameters();
 
-        for (SILParameterList::iterator j = parList.begin(); j != parList.end(); ++j)
+        for (SILParameterTable::Index j = 0; j < parameters.size(); ++j)
         {
-            SILParameter* par = *j;
-            std::cout << "\t" << "Value:       ";
-	    (par->getValue())->dump();
+            ielOut() << "\t" << "Value:       ";
+	    dumpValue(parameters.getValue(j));
 	    //std::cout << "\n\tInstruction: " << *(par->getInstruction()) << std::endl;
-            std::cout << "\t------------\n";
+            ielOut() << "\t------------\n";
         }
     }
 }
@@ -668,6 +1395,7 @@ void SIL::dump(void)
 void SIL::getAnalysisUsage(AnalysisUsage& AU) const
 {
     AU.setPreservesAll();
+    AU.addRequired<ValueNumbering>();
     AU.addRequired<ReachingDef>();
     AU.addRequired<ControlDependence>();
     AU.addRequired<LoopInfo>();
@@ -4,8 +4,20 @@
 #include "ControlDependence/ControlDependence.h"
 #include "ReachingDef/ReachingDef.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/Type.h"
 #include "IELSection.h"
+#include "IELSectionRecord.h"
+#include "SILResult.h"
+#include "LoopMembership.h"
+#include "DefinitionCache.h"
+#include "DebugLocIndex.h"
+#include "AnalysisBudget.h"
+#include "ProfileData.h"
+#include "ResultCache.h"
+#include "ResultDatabase.h"
+#include "ResultWriter.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -18,31 +30,55 @@ using namespace llvm;
 //class SIL : public LoopPass
 class SIL : public FunctionPass
 {
+    //accepted sections of the current function only, see releaseSections
     std::vector<IELSection*> m_ielSections;
+    SILResult m_result;
+    //the analysed loops of the current function
     std::vector<Loop*> m_loops;
     std::map<Value*, Value*> m_toArray;
     std::map<Value*, std::vector<Value*> >  m_arrayDefinitions;
     std::map<Value*, std::vector<BasicBlock*> > m_arrayDefinitionsBlocks;
     ReachingDef* m_currentReachingDef;
+    ControlDependence* m_currentControlDependence;
+    ValueNumbering* m_currentNumbering;
+    LoopInfo* m_currentLoopInfo;
+    LoopMembership m_loopMembership;
+    DefinitionCache m_definitionCache;
+    DebugLocIndex m_debugLocs;
+    AnalysisBudget m_loopBudget;
+    AnalysisBudget m_functionBudget;
+    ProfileData m_profile;
+    ResultCache m_cache;
+    //NULL unless -iel:format is given
+    ResultWriter* m_writer;
     int m_id;
     std::fstream m_file;
     std::map<Loop*, std::set<Loop*> > m_loopGraph;
     std::vector<int> m_histogram;
 
+    //what update keeps from before the transformation, keyed by loop header
+    DenseMap<BasicBlock*, IELSectionRecord> m_reusableRecords;
+    DenseMap<BasicBlock*, IELSection*> m_reusableSections;
+    BitVector m_affectedBlocks;
+
     public:
     
     struct Counts
     {
-        Counts() : totalLoops(0), afterFinalCheck(0) { }
+        Counts() : totalLoops(0), afterFinalCheck(0), budgetExceeded(0), cold(0) { }
         int totalLoops;
         int afterFinalCheck;
+        int budgetExceeded;
+        int cold;
     };
     
     Counts m_counts;
 
         static char ID;
         
-        SIL();
+        //writeGraph is false for the SILs of the SILScheduler workers, which must not
+        //all truncate and write the -iel:graph file
+        explicit SIL(bool writeGraph = true);
         ~SIL();
 
         int getId(void) { return m_id++; }
@@ -52,30 +88,98 @@ class SIL : public FunctionPass
         const std::vector<IELSection*>& getIELSections(void) { return m_ielSections; }
         const std::vector<IELSection*>& getIELSections(void) const { return m_ielSections; }
 
-        //perform step1 as per the paper and at the same time construct set RD for each triplet
-        void runStep1(IELSection* ielSection);
+        //one record per analysed loop of the module, only the current function in -iel:stream mode
+        const SILResult& getResult(void) const { return m_result; }
+
+        //The steps are parameterized by a tracing policy (see SILTrace.h) that decides
+        //what is recorded and printed about rejected parameters.
+
+        //perform step1 as per the paper and at the same time construct sets RD and CP for each triplet.
+        //parameters receives the triplets that steps 2 and 3 have to look at.
+        //Steps 1 and 2 return false when a check site became False and the loop was rejected early
+        template <typename Trace>
+        bool runStep1(IELSection* ielSection, std::vector<SILParameterTable::Index>& parameters, Trace& trace);
+        template <typename Trace>
+        void runStep1(IELSection* ielSection, SILParameterTable::Index silParameter, ControlDependence& cd, Trace& trace);
 
-        void getPhiDefinitions(PHINode* phiNode, std::vector<BasicBlock*>& udChainBlock, std::vector<Value*>& udChainInst, std::vector<PHINode*> phiNodes);
+        //same as runStep1 but only for the triplets finalCheck transitively depends on
+        template <typename Trace>
+        bool runStep1OnSlice(IELSection* ielSection, std::vector<SILParameterTable::Index>& parameters, Trace& trace);
+        void addDependencies(IELSection* ielSection, SILParameterTable::Index silParameter, std::vector<bool>& inSlice, std::vector<SILParameterTable::Index>& parameters);
 
-        void computeCP(IELSection* ielSection, SILParameter* silParameter, ControlDependence& cd);
+        void computeCP(IELSection* ielSection, SILParameterTable::Index silParameter, ControlDependence& cd);
 
         //return true if the SI/L value for this parameter changes from DontKnow to False
-        bool recomputeSILValue(SILParameter* silParameter, IELSection* ielSection);
-        void runStep2(IELSection* ielSection);
+        template <typename Trace>
+        bool recomputeSILValue(SILParameterTable::Index silParameter, IELSection* ielSection, Trace& trace);
+        template <typename Trace>
+        bool runStep2(IELSection* ielSection, const std::vector<SILParameterTable::Index>& parameters, Trace& trace);
 
-        void runStep3(IELSection* ielSection);
+        void runStep3(IELSection* ielSection, const std::vector<SILParameterTable::Index>& parameters);
 
         //TODO: find suitable name
-        //return NULL if this loop's body is not considered an IE/L section
-        //the plan is to ignore all loops which call functions
+        //return NULL if this loop's body is not considered an IE/L section.
+        //Calls are not rejected, ReachingDef treats them as definitions and uses
+        //of the memory their ModRef summaries say they write and read
         IELSection* createIELSection(Loop* loop);
-        bool finalCheck(IELSection* ielSection);
+        template <typename Trace>
+        void collectCheckSites(IELSection* ielSection, Trace& trace);
+        template <typename Trace>
+        bool finalCheck(IELSection* ielSection, Trace& trace);
         void checkOuterLoops(Loop* loop);
 
         //virtual bool runOnLoop(Loop* loop, LPPassManager &lpm);
+        virtual bool doInitialization(Module& module);
+        virtual bool doFinalization(Module& module);
         virtual bool runOnFunction(Function& function);
+
+        //what runOnFunction does, with analyses that were run outside of a pass
+        //manager (see SILScheduler)
+        void analyzeFunction(Function& function, ValueNumbering& numbering, ReachingDef& reachingDef, ControlDependence& controlDependence, LoopInfo& loopInfo);
+
+        //move the records out of the result
+        void takeRecords(std::vector<IELSectionRecord>& records);
+
+        //bring the results up to date after a transformation changed function, which must
+        //be the function SIL ran on last. changedBlocks must hold every block that is new
+        //or whose instructions, predecessors or successors changed, and LoopInfo must
+        //already describe the transformed function. The reaching definitions and control
+        //dependences are updated incrementally, and only the loops that contain a block
+        //whose instructions, reaching definitions or control dependences changed are
+        //analysed again; the other loops keep their records and sections
+        void update(Function& function, const std::vector<BasicBlock*>& changedBlocks);
+
+        bool hasCandidateLoop(Function& function);
+        bool chargePrerequisites(void);
+        void computePrerequisites(void);
+        std::string getCacheOptions(Function& function);
+        void replayEntry(Function& function, const ResultCache::Entry& entry);
+        void analyzeFunction(Function& function);
+        void analyzeLoops(Function& function);
+        IELSection* checkLoop(Loop* loop);
+        bool isReusable(Loop* loop);
+        IELSection* reuseLoop(Loop* loop);
+        template <typename Trace>
         IELSection* checkLoop(Loop* loop);
 
+        //return false once the budget of the current loop or function is used up
+        bool chargeBudget(uint64_t units);
+        void reportBudgetExceeded(Loop* loop, unsigned int numParameters, unsigned int numCheckSites, uint64_t microseconds);
+
+        //with -iel:profile, loops are analysed hottest first, hot loops get a larger
+        //budget and cold loops are not analysed at all
+        void orderByHotness(std::vector<Loop*>& loops);
+        void startLoopBudget(Loop* loop);
+        bool isCold(Loop* loop);
+        void reportCold(Loop* loop);
+
+        void releaseSections(void);
+        void emitRecords(void);
+        void writeRecords(Function& function);
+        void printCounts(void);
+        void analyzeOrReplay(Function& function);
+        virtual void releaseMemory(void);
+
         static void isUsedInLoadStore(GetElementPtrInst* instr, bool &result);
 
         void printAdjacentLoops(Loop* loop, LoopInfo& loopInfo, char* id);
@@ -1,6 +1,10 @@
 #include "llvm/Support/InstIterator.h"
 #include "llvm/Analysis/LoopPass.h"
-#include "ReachingDef/ReachingDef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "LoopMembership.h"
+#include "DefinitionCache.h"
+#include "DebugLocIndex.h"
+#include "Span.h"
 #include "utils.h"
 #include <string>
 #include <iostream>
@@ -10,6 +14,7 @@ using namespace llvm;
 #ifndef SILPARAMETER_H
 #define SILPARAMETER_H
 
+//the values fit in 2 bits, SILParameterTable relies on that for packing
 enum SILValue
 {
     NotInitialized,
@@ -18,13 +23,19 @@ enum SILValue
     DontKnow
 };
 
-typedef std::pair<Value*, BasicBlock*> DefinitionParentPair;
-typedef std::vector<DefinitionParentPair> DefinitionParentPairs;
-
-class SILParameter
+//all the SI/L parameters (beta, v, s) of one loop beta, stored as a struct of arrays.
+//A parameter is identified by its index in the table. The RD and CP lists of the
+//parameters are ranges into buffers shared by the whole table, the definition lists
+//are ranges into the DefinitionCache of the function. Lines are printed from the
+//DebugLocIndex of the function
+class SILParameterTable
 {
 public:
 
+    typedef unsigned int Index;
+    static const Index NotFound = ~0U;
+
+    //the step in which a parameter became False, see SILTrace.h
     enum RejectedStep
     {
         Step1,
@@ -32,71 +43,91 @@ public:
         Step2b
     };
 
-    SILParameter(Loop* beta, Value* value, Instruction* s);
-    void printSILValue(void);
+    SILParameterTable(Loop* beta, LoopBlockSet loopBlocks, DefinitionCache* definitionCache, const DebugLocIndex* debugLocs)
+        :   m_beta(beta),
+            m_loopBlocks(loopBlocks),
+            m_definitionCache(definitionCache),
+            m_debugLocs(debugLocs)
+    {
+    }
+
     Loop* getLoop(void) { return m_beta; }
+    const DebugLocIndex& getDebugLocs(void) const { return *m_debugLocs; }
 
-    Instruction* getInstruction(void) { return m_s; }
-
-    Value* getValue(void) { return m_value; }
-    
-    void addRD(unsigned int i);
-    void printRD(void);
-    void addRDPair(Instruction* inst, BasicBlock* parent) { m_definitionParentPairs.push_back(DefinitionParentPair(inst, parent)); }
-    void addRDPair(DefinitionParentPair pair) { m_definitionParentPairs.push_back(pair); }
-    DefinitionParentPairs getRDPairs(void) { return m_rdPairs; }
-    std::vector<unsigned int> getRD(void) { return m_rd; }
-   
-    void printCP(void);
-    void addCP(Instruction* inst) { m_cp.push_back(inst); }
-    std::vector<Instruction*> getCP(void) { return m_cp; }
-    void setCP(std::vector<Instruction*> cp) { m_cp = cp; }
-
-    SILValue getSILValue(void) { assert(m_silValue != NotInitialized); return m_silValue; }
-    void setSILValue(SILValue silValue);
-    void setSILValue(SILValue silValue, RejectedStep step);
-    void setSILValue(SILValue silValue, RejectedStep step, Instruction* step2Inst, SILParameter* rejectionSource); 
-
-    void constructDefinitionList(ReachingDef* reachingDef);
-
-    unsigned int getNumDefinitions(void) { return m_definitions.size(); }
-    std::vector<Value*> getDefinitions(void) { return m_definitions; }
-    DefinitionParentPairs getDefinitionParentPairs(void) { return m_definitionParentPairs; }
-    Value* getDefinition(unsigned int i) { return m_definitions[i]; }
-    BasicBlock* getDefinitionParent(unsigned int i) { return m_definitionParents[i]; }
-
-    void printDefinitions(void);
-    void print(void);
-    void printRejectionPath(void);
+    //point the table to the loop and block set of a new LoopInfo and LoopMembership
+    void rebind(Loop* beta, LoopBlockSet loopBlocks)
+    {
+        m_beta = beta;
+        m_loopBlocks = loopBlocks;
+    }
+    unsigned int size(void) const { return m_values.size(); }
 
-private:
+    Index add(Value* value, Instruction* s);
 
-    void findDefinitions(PHINode* phiNode);
-    void findDefinitions(PHINode* phiNode, std::map<PHINode*, bool>& visited);
+    //return the parameter that was added last for value or NotFound
+    Index lookup(Value* value) const
+    {
+        DenseMap<Value*, Index>::const_iterator where = m_lookup.find(value);
+        return where != m_lookup.end() ? where->second : NotFound;
+    }
+
+    Value* getValue(Index i) const { return m_values[i]; }
+    Instruction* getInstruction(Index i) const { return m_instructions[i]; }
+
+    SILValue getSILValue(Index i) const
+    {
+        SILValue silValue = (SILValue)((m_silValues[i >> 2] >> ((i & 3) << 1)) & 3);
+        assert(silValue != NotInitialized);
+        return silValue;
+    }
+
+    void setSILValue(Index i, SILValue silValue)
+    {
+        unsigned int shift = (i & 3) << 1;
+        m_silValues[i >> 2] = (m_silValues[i >> 2] & ~(3 << shift)) | (silValue << shift);
+    }
+
+
+    void constructDefinitionList(Index i) { m_definitionRanges[i] = m_definitionCache->lookup(m_values[i]); }
+
+    unsigned int getNumDefinitions(Index i) const { return m_definitionRanges[i].size(); }
+    Span<Value*> getDefinitions(Index i) const { return m_definitionCache->getDefinitions(m_definitionRanges[i]); }
+    Value* getDefinition(Index i, unsigned int j) const { return getDefinitions(i)[j]; }
+    BasicBlock* getDefinitionParent(Index i, unsigned int j) const { return m_definitionCache->getDefinitionParents(m_definitionRanges[i])[j]; }
+
+    //j is an index into the definition list of parameter i
+    void addRD(Index i, unsigned int j);
+    Span<unsigned int> getRD(Index i) const { return makeSpan(m_rd, m_rdRanges[i]); }
+
+    void addCP(Index i, Instruction* inst) { appendToRange(m_cp, m_cpRanges[i], inst); }
+    Span<Instruction*> getCP(Index i) const { return makeSpan(m_cp, m_cpRanges[i]); }
+
+    void printSILValue(Index i);
+    void printDefinitions(Index i);
+    void printRD(Index i);
+    void printCP(Index i);
+    void print(Index i);
 
 private:
 
     Loop* m_beta;
-    
-    Value* m_value;
-    
-    Instruction* m_s;
-    SILValue m_silValue;
-
+    LoopBlockSet m_loopBlocks;
+    DefinitionCache* m_definitionCache;
+    const DebugLocIndex* m_debugLocs;
+
+    //hot, one entry per parameter
+    std::vector<Value*> m_values;
+    std::vector<Instruction*> m_instructions;
+    std::vector<unsigned char> m_silValues; //4 values per byte
+    std::vector<BufferRange> m_definitionRanges;
+    std::vector<BufferRange> m_rdRanges;
+    std::vector<BufferRange> m_cpRanges;
+
+    //shared buffers
     std::vector<unsigned int> m_rd;
-    DefinitionParentPairs m_rdPairs;
     std::vector<Instruction*> m_cp;
 
-    std::vector<Value*> m_definitions;
-    std::vector<BasicBlock*> m_definitionParents;
-    DefinitionParentPairs m_definitionParentPairs;
-    std::vector<int> m_rejectedPath;
-    RejectedStep m_step;
-    Instruction* m_step2Inst; //for lack of a better name
-    SILParameter* m_rejectionSource;
+    DenseMap<Value*, Index> m_lookup;
 };
 
-typedef std::vector<SILParameter*> SILParameterList;
-
-
 #endif //SILPARAMETER_H
@@ -0,0 +1,120 @@
+#include "SILResult.h"
+#include <algorithm>
+
+using namespace llvm;
+
+namespace
+{
+    //orders record indices by the first line of the records
+    class FirstLineLess
+    {
+        public:
+            FirstLineLess(const std::vector<IELSectionRecord>& records) : m_records(records) {}
+
+            bool operator()(unsigned int a, unsigned int b) const { return m_records[a].firstLine < m_records[b].firstLine; }
+            bool operator()(unsigned int a, int line) const { return m_records[a].firstLine < line; }
+            bool operator()(int line, unsigned int b) const { return line < m_records[b].firstLine; }
+
+        private:
+            const std::vector<IELSectionRecord>& m_records;
+    };
+}
+
+void SILResult::add(Loop* loop, const IELSectionRecord& record)
+{
+    m_headers[loop->getHeader()] = m_records.size();
+    add(record);
+}
+
+void SILResult::add(const IELSectionRecord& record)
+{
+    unsigned int index = m_records.size();
+    m_records.push_back(record);
+
+    m_byFunction[record.function].push_back(index);
+    m_fileIndexIsValid = false;
+}
+
+void SILResult::clear(void)
+{
+    m_records.clear();
+    m_functionBegin = 0;
+    m_headers.clear();
+    m_byFunction.clear();
+    m_byFile.clear();
+    m_fileIndexIsValid = true;
+}
+
+void SILResult::removeFunction(DenseMap<BasicBlock*, IELSectionRecord>& records)
+{
+    for (DenseMap<BasicBlock*, unsigned int>::iterator i = m_headers.begin(); i != m_headers.end(); ++i)
+    {
+        records[i->first] = m_records[i->second];
+    }
+
+    //the records of the function are the last ones of their function list
+    for (unsigned int i = m_functionBegin; i < m_records.size(); ++i)
+    {
+        std::vector<unsigned int>& indices = m_byFunction[m_records[i].function];
+        while (!indices.empty() && indices.back() >= m_functionBegin)
+        {
+            indices.pop_back();
+        }
+    }
+
+    m_records.resize(m_functionBegin);
+    m_headers.clear();
+    m_fileIndexIsValid = false;
+}
+
+void SILResult::findByFunction(const std::string& function, std::vector<const IELSectionRecord*>& records) const
+{
+    StringMap<std::vector<unsigned int> >::const_iterator where = m_byFunction.find(function);
+    if (where == m_byFunction.end()) return;
+
+    const std::vector<unsigned int>& indices = where->second;
+    for (std::vector<unsigned int>::const_iterator i = indices.begin(); i != indices.end(); ++i)
+    {
+        records.push_back(&m_records[*i]);
+    }
+}
+
+void SILResult::buildFileIndex(void) const
+{
+    m_byFile.clear();
+
+    for (unsigned int i = 0; i < m_records.size(); ++i)
+    {
+        m_byFile[m_records[i].sourceFile].push_back(i);
+    }
+
+    for (StringMap<std::vector<unsigned int> >::iterator i = m_byFile.begin(); i != m_byFile.end(); ++i)
+    {
+        std::stable_sort(i->second.begin(), i->second.end(), FirstLineLess(m_records));
+    }
+
+    m_fileIndexIsValid = true;
+}
+
+void SILResult::findByLineRange(const std::string& sourceFile, int firstLine, int lastLine, std::vector<const IELSectionRecord*>& records) const
+{
+    if (!m_fileIndexIsValid)
+    {
+        buildFileIndex();
+    }
+
+    StringMap<std::vector<unsigned int> >::const_iterator where = m_byFile.find(sourceFile);
+    if (where == m_byFile.end()) return;
+
+    //only loops that start before lastLine can overlap the range
+    const std::vector<unsigned int>& indices = where->second;
+    std::vector<unsigned int>::const_iterator end = std::upper_bound(indices.begin(), indices.end(), lastLine, FirstLineLess(m_records));
+
+    for (std::vector<unsigned int>::const_iterator i = indices.begin(); i != end; ++i)
+    {
+        if (m_records[*i].lastLine >= firstLine)
+        {
+            records.push_back(&m_records[*i]);
+        }
+    }
+}
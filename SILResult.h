@@ -0,0 +1,82 @@
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "IELSectionRecord.h"
+#include <vector>
+#include <string>
+
+using namespace llvm;
+
+#ifndef SILRESULT_H
+#define SILRESULT_H
+
+//the result of SIL, indexed for downstream passes. Loops of the function SIL ran on
+//last can be looked up by header in constant time; the records of the whole module
+//can be queried by function and by source line range
+class SILResult
+{
+    public:
+
+        SILResult() : m_functionBegin(0), m_fileIndexIsValid(true) {}
+
+        //forget the headers of the previous function, its blocks may be freed
+        void beginFunction(void)
+        {
+            m_headers.clear();
+            m_functionBegin = m_records.size();
+        }
+
+        void add(Loop* loop, const IELSectionRecord& record);
+
+        //add the record of a loop that is gone already, it can not be looked up by loop
+        void add(const IELSectionRecord& record);
+        void clear(void);
+
+        //take the records of the function SIL ran on last out of the result so that
+        //they can be added again, keyed by the header of their loop
+        void removeFunction(DenseMap<BasicBlock*, IELSectionRecord>& records);
+
+        const std::vector<IELSectionRecord>& getRecords(void) const { return m_records; }
+
+        //the records added since beginFunction
+        void getFunctionRecords(std::vector<IELSectionRecord>& records) const
+        {
+            records.assign(m_records.begin() + m_functionBegin, m_records.end());
+        }
+
+        //return the record of loop or NULL if loop was not analysed.
+        //loop must belong to the function SIL ran on last
+        const IELSectionRecord* lookup(Loop* loop) const
+        {
+            DenseMap<BasicBlock*, unsigned int>::const_iterator where = m_headers.find(loop->getHeader());
+            return where != m_headers.end() ? &m_records[where->second] : NULL;
+        }
+
+        bool isIELSection(Loop* loop) const
+        {
+            const IELSectionRecord* record = lookup(loop);
+            return record != NULL && record->isIELSection();
+        }
+
+        //append the records of all loops analysed in function
+        void findByFunction(const std::string& function, std::vector<const IELSectionRecord*>& records) const;
+
+        //append the records of all loops of sourceFile whose line range overlaps [firstLine, lastLine]
+        void findByLineRange(const std::string& sourceFile, int firstLine, int lastLine, std::vector<const IELSectionRecord*>& records) const;
+
+    private:
+        void buildFileIndex(void) const;
+
+    private:
+        std::vector<IELSectionRecord> m_records;
+        unsigned int m_functionBegin; //first record of the function SIL ran on last
+        DenseMap<BasicBlock*, unsigned int> m_headers;
+        StringMap<std::vector<unsigned int> > m_byFunction;
+
+        //per source file, the records sorted by first line. Built on the first line
+        //range query after records were added
+        mutable StringMap<std::vector<unsigned int> > m_byFile;
+        mutable bool m_fileIndexIsValid;
+};
+
+#endif //SILRESULT_H
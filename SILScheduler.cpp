@@ -0,0 +1,155 @@
+#include "SILScheduler.h"
+#include "llvm/Support/CommandLine.h"
+#include "utils.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace llvm;
+
+extern cl::opt<unsigned> silThreads;
+extern cl::opt<bool> streamRecords;
+extern cl::opt<std::string> databaseFile;
+extern cl::opt<std::string> graphFile;
+
+char SILScheduler::ID = 0;
+static RegisterPass<SILScheduler> silScheduler("iel-parallel", "find all IE/L sections, analysing functions concurrently");
+
+SILScheduler::SILScheduler()
+    :   ModulePass(&ID)
+{
+}
+
+void* SILScheduler::runWorker(void* arg)
+{
+    ModuleWork* work = static_cast<ModuleWork*>(arg);
+
+    //the analyses are large, so they are only created once per thread
+    Worker* worker = new Worker();
+    worker->sil.doInitialization(*work->module);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&work->lock);
+        unsigned int i = work->next++;
+        pthread_mutex_unlock(&work->lock);
+
+        if (i >= work->functions.size()) break;
+
+        analyzeFunction(*worker, *work->functions[i], *work->modRef, work->results[i]);
+    }
+
+    delete worker;
+    return NULL;
+}
+
+//the same steps the pass manager takes for -iel, with the output of SIL going to the
+//buffers of the function. The calling thread may have redirected its output already,
+//like the ielsections driver does, so that is restored afterwards
+void SILScheduler::analyzeFunction(Worker& worker, Function& function, const ModRef& modRef, FunctionResult& result)
+{
+    std::ostream& previousOut = ielOut();
+    std::ostream& previousErr = ielErr();
+    std::ostringstream out;
+    std::ostringstream err;
+    redirectOutput(&out, &err);
+
+    worker.numbering.runOnFunction(function);
+    worker.dominatorTree.runOnFunction(function);
+    worker.loopInfo.releaseMemory();
+    worker.loopInfo.getBase().Calculate(worker.dominatorTree.getBase());
+    worker.reachingDef.setFunction(function, worker.numbering, modRef);
+    worker.controlDependence.setFunction(function, worker.numbering);
+
+    worker.sil.analyzeFunction(function, worker.numbering, worker.reachingDef, worker.controlDependence, worker.loopInfo);
+
+    //in -iel:stream mode the records were printed already
+    if (!streamRecords)
+    {
+        worker.sil.takeRecords(result.records);
+    }
+    worker.sil.releaseMemory();
+
+    redirectOutput(&previousOut, &previousErr);
+    result.out = out.str();
+    result.err = err.str();
+}
+
+//the records are kept until the next module, like those of SIL
+bool SILScheduler::runOnModule(Module& module)
+{
+    m_result.clear();
+
+    //the workers would all write the same file
+    if (!graphFile.empty())
+    {
+        std::cerr << "iel: -iel:graph is not supported with -iel-parallel and is ignored" << std::endl;
+    }
+
+    ModuleWork work;
+    work.module = &module;
+    work.modRef = &getAnalysis<ModRef>();
+    work.next = 0;
+    pthread_mutex_init(&work.lock, NULL);
+
+    for (Module::iterator i = module.begin(); i != module.end(); ++i)
+    {
+        if (!i->isDeclaration())
+        {
+            work.functions.push_back(i);
+        }
+    }
+    work.results.resize(work.functions.size());
+
+    unsigned int numThreads = silThreads;
+    if (numThreads == 0)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = processors > 0 ? processors : 1;
+    }
+    numThreads = std::min(numThreads, (unsigned int)work.functions.size());
+
+    //the calling thread is one of the workers
+    std::vector<pthread_t> workers;
+    for (unsigned int i = 1; i < numThreads; ++i)
+    {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, runWorker, &work) != 0) break;
+        workers.push_back(worker);
+    }
+
+    runWorker(&work);
+
+    for (std::vector<pthread_t>::iterator i = workers.begin(); i != workers.end(); ++i)
+    {
+        pthread_join(*i, NULL);
+    }
+
+    pthread_mutex_destroy(&work.lock);
+
+    for (std::vector<FunctionResult>::iterator i = work.results.begin(); i != work.results.end(); ++i)
+    {
+        ielOut() << i->out;
+        ielErr() << i->err;
+
+        for (std::vector<IELSectionRecord>::iterator j = i->records.begin(); j != i->records.end(); ++j)
+        {
+            m_result.add(*j);
+        }
+    }
+
+    std::string error;
+    if (!databaseFile.empty() && !streamRecords && !ResultDatabase::write(databaseFile, m_result.getRecords(), error))
+    {
+        std::cerr << "iel: " << error << std::endl;
+    }
+
+    return false;
+}
+
+void SILScheduler::getAnalysisUsage(AnalysisUsage& AU) const
+{
+    AU.setPreservesAll();
+    AU.addRequired<ModRef>();
+}
@@ -0,0 +1,78 @@
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "ValueNumbering/ValueNumbering.h"
+#include "ReachingDef/ReachingDef.h"
+#include "ControlDependence/ControlDependence.h"
+#include "ModRef/ModRef.h"
+#include "SIL.h"
+#include "SILResult.h"
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+using namespace llvm;
+
+#ifndef SILSCHEDULER_H
+#define SILSCHEDULER_H
+
+//runs SIL on the functions of a module with -iel:threads threads. Every thread has
+//its own ValueNumbering, DominatorTree, LoopInfo, ReachingDef, ControlDependence and
+//SIL, which are run outside of the pass manager, and ModRef is shared. Each function
+//prints into its own buffers, which are written out in module order once all
+//functions are done, so the output does not depend on the scheduling
+class SILScheduler : public ModulePass
+{
+    public:
+        static char ID;
+
+        SILScheduler();
+
+        virtual bool runOnModule(Module& module);
+        virtual void getAnalysisUsage(AnalysisUsage& AU) const;
+
+        //one record per analysed loop of the module, in module order
+        const SILResult& getResult(void) const { return m_result; }
+
+    private:
+        //what the analysis of one function printed and found
+        struct FunctionResult
+        {
+            std::string out;
+            std::string err;
+            std::vector<IELSectionRecord> records;
+        };
+
+        //the analyses of one thread, reused for all the functions it analyses
+        struct Worker
+        {
+            Worker() : sil(false) {}
+
+            ValueNumbering numbering;
+            DominatorTree dominatorTree;
+            LoopInfo loopInfo;
+            ReachingDef reachingDef;
+            ControlDependence controlDependence;
+            SIL sil;
+        };
+
+        //the functions of the module, claimed one at a time by the workers
+        struct ModuleWork
+        {
+            Module* module;
+            const ModRef* modRef;
+            std::vector<Function*> functions;
+            std::vector<FunctionResult> results;
+            unsigned int next;
+            pthread_mutex_t lock;
+        };
+
+        static void* runWorker(void* work);
+        static void analyzeFunction(Worker& worker, Function& function, const ModRef& modRef, FunctionResult& result);
+
+    private:
+        SILResult m_result;
+};
+
+#endif //SILSCHEDULER_H
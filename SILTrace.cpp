@@ -0,0 +1,84 @@
+#include "SILTrace.h"
+#include "llvm/Support/CommandLine.h"
+#include "utils.h"
+
+using namespace llvm;
+
+extern cl::opt<bool> printRejected;
+extern cl::opt<bool> explain;
+
+void ExplainTrace::rejected(SILParameterTable::Index parameter, SILParameterTable::RejectedStep step, Instruction* inst, SILParameterTable::Index source)
+{
+    Event event;
+    event.parameter = parameter;
+    event.source = source;
+    event.inst = inst;
+    event.step = step;
+
+    m_eventOf[parameter] = m_events.size();
+    m_events.push_back(event);
+}
+
+void ExplainTrace::missingParameter(Instruction* user, Value* operand)
+{
+    ielOut() << "error: " << m_ielSection->getSILParameters().getDebugLocs().getLine(user) << std::endl;
+    dumpValue(user);
+    ielOut() << user->getParent()->getName().str() << std::endl;
+    ielOut() << std::endl;
+    dumpValue(operand);
+}
+
+void ExplainTrace::rejectedCheckSite(const IELSection::CheckSite& checkSite)
+{
+    if (printRejected)
+    {
+        ielErr() << (checkSite.kind == IELSection::CheckSite::ArrayIndex ? "Array index\n" : "Branch\n");
+        m_ielSection->getSILParameters().print(checkSite.parameter);
+
+        if (explain)
+        {
+            printRejectionPath(checkSite.parameter);
+        }
+
+        ielErr() << std::endl;
+    }
+}
+
+void ExplainTrace::printRejectionPath(SILParameterTable::Index parameter)
+{
+    SILParameterTable& silParameters = m_ielSection->getSILParameters();
+    const DebugLocIndex& debugLocs = silParameters.getDebugLocs();
+
+    while (parameter != SILParameterTable::NotFound)
+    {
+        DenseMap<SILParameterTable::Index, unsigned int>::iterator where = m_eventOf.find(parameter);
+        if (where == m_eventOf.end())
+        {
+            return;
+        }
+
+        const Event& event = m_events[where->second];
+
+        if (event.step == SILParameterTable::Step1)
+        {
+            ielErr() << "Step1: ";
+            Span<Value*> definitions = silParameters.getDefinitions(parameter);
+            for (Span<Value*>::iterator i = definitions.begin(); i != definitions.end(); ++i)
+            {
+                if (Instruction* inst = dyn_cast<Instruction>(*i))
+                {
+                    ielErr() << debugLocs.getLine(inst) << "\t";
+                }
+            }
+
+            ielErr() << std::endl;
+        }
+        else
+        {
+            ielErr() << (event.step == SILParameterTable::Step2a ? "Step2a: " : "Step2b: ");
+            ielErr() << debugLocs.getLine(event.inst) << std::endl;
+        }
+
+        parameter = event.source;
+    }
+}
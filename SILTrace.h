@@ -0,0 +1,64 @@
+#include "IELSection.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef SILTRACE_H
+#define SILTRACE_H
+
+//The steps of SIL are parameterized by a tracing policy. A policy decides whether
+//rejected loops are given up on at the first False check site (FailFast), what is
+//remembered about why a parameter became False and what is printed about it.
+
+//tracing policy of the production build: nothing is recorded or printed and every
+//member is empty, so the calls compile down to nothing
+class NoTrace
+{
+    public:
+        static const bool FailFast = true;
+
+        NoTrace(IELSection* ielSection) {}
+
+        void rejected(SILParameterTable::Index parameter, SILParameterTable::RejectedStep step) {}
+        void rejected(SILParameterTable::Index parameter, SILParameterTable::RejectedStep step, Instruction* inst, SILParameterTable::Index source) {}
+        void missingParameter(Instruction* user, Value* operand) {}
+        void rejectedCheckSite(const IELSection::CheckSite& checkSite) {}
+};
+
+//tracing policy for explaining rejections (-iel:explain and -iel:print-rejected).
+//The analysis runs to completion and every parameter that becomes False is logged
+//as a compact event, from which the rejection path can be rebuilt afterwards
+class ExplainTrace
+{
+    public:
+        static const bool FailFast = false;
+
+        ExplainTrace(IELSection* ielSection) : m_ielSection(ielSection) {}
+
+        void rejected(SILParameterTable::Index parameter, SILParameterTable::RejectedStep step)
+        {
+            rejected(parameter, step, NULL, SILParameterTable::NotFound);
+        }
+
+        void rejected(SILParameterTable::Index parameter, SILParameterTable::RejectedStep step, Instruction* inst, SILParameterTable::Index source);
+        void missingParameter(Instruction* user, Value* operand);
+        void rejectedCheckSite(const IELSection::CheckSite& checkSite);
+
+        void printRejectionPath(SILParameterTable::Index parameter);
+
+    private:
+        struct Event
+        {
+            SILParameterTable::Index parameter;
+            SILParameterTable::Index source; //NotFound for Step1
+            Instruction* inst; //the definition or the branch that made parameter False, NULL for Step1
+            SILParameterTable::RejectedStep step;
+        };
+
+        IELSection* m_ielSection;
+        std::vector<Event> m_events;
+        DenseMap<SILParameterTable::Index, unsigned int> m_eventOf;
+};
+
+#endif //SILTRACE_H
@@ -0,0 +1,63 @@
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+#ifndef SPAN_H
+#define SPAN_H
+
+//read-only view of a contiguous run of elements in a shared buffer.
+//Only valid until the next append to that buffer
+template <typename T>
+class Span
+{
+public:
+    typedef const T* iterator;
+
+    Span() : m_begin(NULL), m_end(NULL) {}
+    Span(const T* begin, const T* end) : m_begin(begin), m_end(end) {}
+
+    iterator begin(void) const { return m_begin; }
+    iterator end(void) const { return m_end; }
+    unsigned int size(void) const { return m_end - m_begin; }
+    bool empty(void) const { return m_begin == m_end; }
+    const T& operator[](unsigned int i) const { assert(i < size()); return m_begin[i]; }
+
+private:
+    const T* m_begin;
+    const T* m_end;
+};
+
+//[begin, end) range of a run of elements in a shared buffer. Unlike a Span it
+//stays valid when the buffer grows
+struct BufferRange
+{
+    BufferRange() : begin(0), end(0) {}
+    unsigned int size(void) const { return end - begin; }
+
+    unsigned int begin;
+    unsigned int end;
+};
+
+//the ranges of a buffer are filled one at a time, so appending to a range only
+//ever happens at the end of the buffer
+template <typename T>
+inline void appendToRange(std::vector<T>& buffer, BufferRange& range, const T& element)
+{
+    if (range.size() == 0)
+    {
+        range.begin = range.end = buffer.size();
+    }
+
+    assert(range.end == buffer.size() && "ranges must be filled one at a time");
+    buffer.push_back(element);
+    ++range.end;
+}
+
+template <typename T>
+inline Span<T> makeSpan(const std::vector<T>& buffer, const BufferRange& range)
+{
+    if (range.size() == 0) return Span<T>();
+    return Span<T>(&buffer[range.begin], &buffer[0] + range.end);
+}
+
+#endif //SPAN_H
@@ -0,0 +1,129 @@
+#include "UpdateCheck.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/ADT/StringMap.h"
+#include "SIL.h"
+#include "utils.h"
+
+using namespace llvm;
+
+char UpdateCheck::ID = 0;
+static RegisterPass<UpdateCheck> updateCheck("iel-check-update", "check that SIL::update gives the same records as a fresh analysis");
+
+UpdateCheck::UpdateCheck()
+    :   FunctionPass(&ID)
+{
+}
+
+//the time is left out, it differs between any two runs
+static bool isSameResult(const IELSectionRecord& a, const IELSectionRecord& b)
+{
+    return a.sourceFile == b.sourceFile && a.firstLine == b.firstLine && a.lastLine == b.lastLine
+        && a.verdict == b.verdict && a.rejectionStep == b.rejectionStep
+        && a.numParameters == b.numParameters && a.numCheckSites == b.numCheckSites;
+}
+
+unsigned int UpdateCheck::compare(const std::vector<IELSectionRecord>& updated, const std::vector<IELSectionRecord>& fresh)
+{
+    StringMap<const IELSectionRecord*> freshByHeader;
+    for (std::vector<IELSectionRecord>::const_iterator i = fresh.begin(); i != fresh.end(); ++i)
+    {
+        freshByHeader[i->header] = &*i;
+    }
+
+    unsigned int differences = 0;
+    for (std::vector<IELSectionRecord>::const_iterator i = updated.begin(); i != updated.end(); ++i)
+    {
+        StringMap<const IELSectionRecord*>::iterator where = freshByHeader.find(i->header);
+        if (where != freshByHeader.end() && isSameResult(*i, *where->second))
+        {
+            freshByHeader.erase(where);
+            continue;
+        }
+
+        ++differences;
+        ielErr() << "updated: ";
+        i->print(ielErr());
+        if (where != freshByHeader.end())
+        {
+            ielErr() << "fresh:   ";
+            where->second->print(ielErr());
+            freshByHeader.erase(where);
+        }
+    }
+
+    //loops that only the fresh analysis found
+    for (StringMap<const IELSectionRecord*>::iterator i = freshByHeader.begin(); i != freshByHeader.end(); ++i)
+    {
+        ++differences;
+        ielErr() << "fresh:   ";
+        i->second->print(ielErr());
+    }
+
+    return differences;
+}
+
+bool UpdateCheck::runOnFunction(Function& function)
+{
+    SIL& sil = getAnalysis<SIL>();
+    ValueNumbering& numbering = getAnalysis<ValueNumbering>();
+    ReachingDef& reachingDef = getAnalysis<ReachingDef>();
+    ControlDependence& controlDependence = getAnalysis<ControlDependence>();
+    LoopInfo& loopInfo = getAnalysis<LoopInfo>();
+
+    std::vector<BasicBlock*> headers;
+    for (Function::iterator block = function.begin(); block != function.end(); ++block)
+    {
+        Loop* loop = loopInfo.getLoopFor(block);
+        if (loop != NULL && loop->getHeader() == block)
+        {
+            headers.push_back(block);
+        }
+    }
+
+    if (headers.empty()) return false;
+
+    //SplitBlock keeps LoopInfo and the DominatorTree up to date. The successors of
+    //the new block get a new predecessor, so they changed as well
+    std::vector<BasicBlock*> changedBlocks;
+    for (std::vector<BasicBlock*>::iterator i = headers.begin(); i != headers.end(); ++i)
+    {
+        BasicBlock* rest = SplitBlock(*i, (*i)->getFirstNonPHI(), this);
+
+        changedBlocks.push_back(*i);
+        changedBlocks.push_back(rest);
+        for (succ_iterator j = succ_begin(rest); j != succ_end(rest); ++j)
+        {
+            changedBlocks.push_back(*j);
+        }
+    }
+
+    sil.update(function, changedBlocks);
+
+    std::vector<IELSectionRecord> updated;
+    sil.getResult().getFunctionRecords(updated);
+
+    reachingDef.setFunction(function, numbering, reachingDef.getModRef());
+    controlDependence.setFunction(function, numbering);
+    sil.analyzeFunction(function, numbering, reachingDef, controlDependence, loopInfo);
+
+    std::vector<IELSectionRecord> fresh;
+    sil.getResult().getFunctionRecords(fresh);
+
+    unsigned int differences = compare(updated, fresh);
+    ielErr() << "update check: " << function.getName().str() << ": " << fresh.size() << " loops, "
+             << differences << " differences" << std::endl;
+
+    return true;
+}
+
+void UpdateCheck::getAnalysisUsage(AnalysisUsage& AU) const
+{
+    AU.addRequired<ValueNumbering>();
+    AU.addRequired<ReachingDef>();
+    AU.addRequired<ControlDependence>();
+    AU.addRequired<DominatorTree>();
+    AU.addRequired<LoopInfo>();
+    AU.addRequired<SIL>();
+}
@@ -0,0 +1,33 @@
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+#include "IELSectionRecord.h"
+#include <vector>
+
+using namespace llvm;
+
+#ifndef UPDATECHECK_H
+#define UPDATECHECK_H
+
+//example and check of SIL::update. The header of every loop is split after its phi
+//nodes, which moves the rest of the header into a new block of the loop, and SIL is
+//brought up to date with update. Then the transformed function is analysed from
+//scratch and every loop whose record differs from the updated one is printed.
+//
+//The fresh records are added to the result of SIL as well, so do not combine it with
+//-iel:db
+class UpdateCheck : public FunctionPass
+{
+    public:
+        static char ID;
+
+        UpdateCheck();
+
+        virtual bool runOnFunction(Function& function);
+        virtual void getAnalysisUsage(AnalysisUsage& AU) const;
+
+    private:
+        //return the number of loops whose records differ
+        static unsigned int compare(const std::vector<IELSectionRecord>& updated, const std::vector<IELSectionRecord>& fresh);
+};
+
+#endif //UPDATECHECK_H
@@ -0,0 +1,94 @@
+//===-- ValueNumbering.cpp - ValueNumbering class code ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the defintion of the ValueNumbering class, which is
+// used for numbering the blocks, instructions and stores of a function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ValueNumbering.h"
+
+using namespace llvm;
+
+char ValueNumbering::ID;
+const unsigned ValueNumbering::Unnumbered;
+static RegisterPass<ValueNumbering>
+C("value-numbering", "Number blocks, instructions and stores densely", false, true);
+
+//===----------------------------------------------------------------------===//
+// ValueNumbering Implementation
+//===----------------------------------------------------------------------===//
+
+// Number the blocks, instructions and stores of F in layout order
+//
+bool ValueNumbering::runOnFunction(Function& F) {
+    releaseMemory();
+
+    for (Function::iterator B = F.begin(), E = F.end(); B != E; ++B)
+    {
+        BlockNumbers[B] = Blocks.size();
+        Blocks.push_back(B);
+
+        for (BasicBlock::iterator I = B->begin(), IE = B->end(); I != IE; ++I)
+        {
+            InstructionNumbers[I] = Instructions.size();
+            Instructions.push_back(I);
+
+            if (StoreInst* S = dyn_cast<StoreInst>(I))
+            {
+                StoreNumbers[S] = Stores.size();
+                Stores.push_back(S);
+            }
+        }
+    }
+
+    return false;
+}
+
+// Number F again and remember where the old numbers went
+//
+void ValueNumbering::renumber(Function& F) {
+    std::vector<BasicBlock*> OldBlocks;
+    std::vector<StoreInst*> OldStores;
+    OldBlocks.swap(Blocks);
+    OldStores.swap(Stores);
+
+    runOnFunction(F);
+
+    BlockRemap.assign(OldBlocks.size(), Unnumbered);
+    for (unsigned N = 0, E = OldBlocks.size(); N != E; ++N)
+    {
+        NumberMapTy::const_iterator I = BlockNumbers.find(OldBlocks[N]);
+        if (I != BlockNumbers.end())
+            BlockRemap[N] = I->second;
+    }
+
+    StoreRemap.assign(OldStores.size(), Unnumbered);
+    for (unsigned N = 0, E = OldStores.size(); N != E; ++N)
+    {
+        NumberMapTy::const_iterator I = StoreNumbers.find(OldStores[N]);
+        if (I != StoreNumbers.end())
+            StoreRemap[N] = I->second;
+    }
+}
+
+void ValueNumbering::releaseMemory() {
+    BlockNumbers.clear();
+    InstructionNumbers.clear();
+    StoreNumbers.clear();
+    Blocks.clear();
+    Instructions.clear();
+    Stores.clear();
+    BlockRemap.clear();
+    StoreRemap.clear();
+}
+
+void ValueNumbering::getAnalysisUsage(AnalysisUsage& AU) const {
+    AU.setPreservesAll();
+}
@@ -0,0 +1,101 @@
+//===- ValueNumbering.h - ValueNumbering class definition -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the declaration of the ValueNumbering class, which
+// assigns dense numbers to the blocks, instructions and stores of a function.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_VALUENUMBERING_H
+#define LLVM_VALUENUMBERING_H
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+
+namespace llvm {
+
+//===----------------------------------------------------------------------===//
+//
+// ValueNumbering class - This class numbers the basic blocks, the instructions
+//    and the stores of a function densely, in layout order, so that the other
+//    ielsections passes can keep their per block and per store data in flat
+//    arrays and bit vectors instead of maps keyed by pointers
+//
+class ValueNumbering : public FunctionPass {
+    typedef DenseMap<const Value*, unsigned> NumberMapTy;
+
+    NumberMapTy BlockNumbers;
+    NumberMapTy InstructionNumbers;
+    NumberMapTy StoreNumbers;
+
+    std::vector<BasicBlock*> Blocks;
+    std::vector<Instruction*> Instructions;
+    std::vector<StoreInst*> Stores;
+
+    // old number -> new number, filled by renumber
+    std::vector<unsigned> BlockRemap;
+    std::vector<unsigned> StoreRemap;
+
+    public:
+        static char ID;
+        static const unsigned Unnumbered = ~0U;
+
+        ValueNumbering() : FunctionPass(&ID) {}
+
+        // Number the blocks, instructions and stores of F
+        virtual bool runOnFunction(Function& F);
+
+        virtual void getAnalysisUsage(AnalysisUsage& AU) const;
+
+        virtual void releaseMemory();
+
+        // Number F again after it was transformed. The numbers the blocks and
+        // stores had before can be translated with getNewBlockNumber and
+        // getNewStoreNumber until the next call. A value that was deleted and
+        // a new one that was allocated at the same address look the same, so
+        // the users must treat the blocks that changed as new anyway
+        void renumber(Function& F);
+
+        // return the number an old block or store has now or Unnumbered if it
+        // is gone. Only valid after renumber and before releaseMemory
+        unsigned getNewBlockNumber(unsigned Old) const {
+            assert(Old < BlockRemap.size() && "block was not numbered before the last renumber");
+            return BlockRemap[Old];
+        }
+        unsigned getNewStoreNumber(unsigned Old) const {
+            assert(Old < StoreRemap.size() && "store was not numbered before the last renumber");
+            return StoreRemap[Old];
+        }
+
+        unsigned getNumBlocks() const { return Blocks.size(); }
+        unsigned getNumInstructions() const { return Instructions.size(); }
+        unsigned getNumStores() const { return Stores.size(); }
+
+        unsigned getBlockNumber(const BasicBlock* B) const { return lookup(BlockNumbers, B); }
+        unsigned getInstructionNumber(const Instruction* I) const { return lookup(InstructionNumbers, I); }
+        unsigned getStoreNumber(const StoreInst* S) const { return lookup(StoreNumbers, S); }
+
+        BasicBlock* getBlock(unsigned N) const { return Blocks[N]; }
+        Instruction* getInstruction(unsigned N) const { return Instructions[N]; }
+        StoreInst* getStore(unsigned N) const { return Stores[N]; }
+
+    private:
+        static unsigned lookup(const NumberMapTy& Numbers, const Value* V) {
+            NumberMapTy::const_iterator I = Numbers.find(V);
+            assert(I != Numbers.end() && "value is not in the current function");
+            return I->second;
+        }
+};
+
+} //End llvm namespace
+
+#endif // LLVM_VALUENUMBERING_H
@@ -0,0 +1,782 @@
+//ielsections: find the IE/L sections of bitcode or textual IR files in one process.
+//Every input is parsed, promoted with mem2reg and analysed in memory, so there are
+//no per file opt invocations and no shared temporary files. The inputs are expected
+//to be compiled without optimisations, e.g. with llvm-gcc -O0 -emit-llvm -c
+//
+//Directories and -files-from lists make up a corpus. With -j the files of a corpus
+//are analysed by a pool of threads, each with its own LLVMContext, and the records
+//are written in input order followed by totals over the whole corpus
+//
+//With -lazy, bitcode is mapped instead of parsed up front and only the bodies of the
+//functions that contain a loop, and of the functions they call, are materialised.
+//Each body is dropped again once SIL is done with its function
+//
+//With -serve, the records of the corpus stay resident and queries are answered over
+//a Unix domain socket until a client asks the server to shut down, see serve
+
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/IRReader.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/Path.h"
+#include "llvm/System/Signals.h"
+#include "llvm/System/Threading.h"
+#include "../SIL.h"
+#include "../SILScheduler.h"
+#include "../SILResult.h"
+#include "../ResultDatabase.h"
+#include "../utils.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <set>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace llvm;
+
+extern cl::opt<unsigned> silThreads;
+
+static cl::list<std::string> inputFiles(cl::Positional, cl::desc("<input bitcode or IR files or directories>"), cl::ZeroOrMore);
+static cl::opt<std::string> fileList("files-from", cl::desc("Also analyse the files and directories listed in filename, one per line"), cl::value_desc("filename"));
+static cl::opt<unsigned> numThreads("j", cl::desc("Number of files analysed in parallel (0 = one per processor)"), cl::init(1));
+static cl::opt<std::string> outputFile("o", cl::desc("Write the records to filename instead of standard output"), cl::value_desc("filename"), cl::init("-"));
+static cl::opt<std::string> database("db", cl::desc("Also write the records of all files to a result database for iel-query"), cl::value_desc("filename"));
+static cl::opt<bool> noMem2Reg("no-mem2reg", cl::desc("Do not run mem2reg, the inputs are already promoted"));
+static cl::opt<bool> lazy("lazy", cl::desc("Map bitcode inputs and only materialise the functions with loops and the functions they call"));
+static cl::opt<std::string> socketPath("serve", cl::desc("Keep the records resident and answer queries on the Unix domain socket filename, analysing changed inputs again"), cl::value_desc("filename"));
+
+//one input of the corpus and what was found in it
+struct FileResult
+{
+    FileResult(const std::string& filename, uint64_t size) : filename(filename), size(size), isRead(false) {}
+
+    std::string filename;
+    uint64_t size;
+    sys::TimeValue modified; //when the analysed version of the file was written
+    bool isRead;
+    std::string error;
+    std::vector<IELSectionRecord> records;
+
+    //what the analysis printed to ielOut and ielErr, written out in input order by
+    //printOutput so that the workers of -j do not interleave
+    std::string out;
+    std::string err;
+};
+
+//the files of the corpus, claimed one at a time by the workers
+struct CorpusWork
+{
+    std::vector<FileResult>* files;
+    std::vector<unsigned int> order;
+    unsigned int next;
+    pthread_mutex_t lock;
+};
+
+//drops the body of each function after SIL, it is read again from the mapped
+//bitcode if it is ever needed. The ModRef summaries are kept per function, so
+//calls to a dropped function are still resolved precisely
+class ReleaseBody : public FunctionPass
+{
+    public:
+        static char ID;
+
+        ReleaseBody() : FunctionPass(&ID) {}
+
+        virtual const char* getPassName(void) const { return "Release function bodies"; }
+
+        virtual bool runOnFunction(Function& function)
+        {
+            if (!function.isDematerializable()) return false;
+
+            function.Dematerialize();
+            return true;
+        }
+
+        //the summaries of a dropped body stay valid, and SIL needs ModRef for the
+        //next function
+        virtual void getAnalysisUsage(AnalysisUsage& AU) const { AU.setPreservesAll(); }
+};
+
+char ReleaseBody::ID = 0;
+
+//return true if the control flow graph of function has a cycle. This is a superset
+//of the functions LoopInfo finds a loop in, and needs no dominator tree
+static bool hasCycle(const Function& function)
+{
+    SmallVector<std::pair<const BasicBlock*, const BasicBlock*>, 8> backEdges;
+    FindFunctionBackedges(function, backEdges);
+    return !backEdges.empty();
+}
+
+//materialise every function with a cycle and everything it may call directly or
+//transitively, which ModRef needs for the summaries. The bodies of the other
+//functions are dropped again right after they were looked at
+static bool materializeLoopFunctions(Module& module, std::string& error)
+{
+    std::vector<Function*> worklist;
+    DenseSet<Function*> needed;
+
+    for (Module::iterator i = module.begin(); i != module.end(); ++i)
+    {
+        if (!i->isMaterializable()) continue;
+        if (i->Materialize(&error)) return false;
+
+        if (hasCycle(*i))
+        {
+            needed.insert(i);
+            worklist.push_back(i);
+        }
+        else
+        {
+            i->Dematerialize();
+        }
+    }
+
+    while (!worklist.empty())
+    {
+        Function* function = worklist.back();
+        worklist.pop_back();
+
+        for (inst_iterator i = inst_begin(function); i != inst_end(function); ++i)
+        {
+            if (!isa<CallInst>(*i) && !isa<InvokeInst>(*i)) continue;
+
+            Function* callee = dyn_cast<Function>(CallSite::get(&*i).getCalledValue()->stripPointerCasts());
+            if (callee == NULL || !needed.insert(callee).second) continue;
+
+            if (callee->isMaterializable())
+            {
+                if (callee->Materialize(&error)) return false;
+            }
+
+            worklist.push_back(callee);
+        }
+    }
+
+    return true;
+}
+
+//map filename and read everything but the function bodies
+static Module* loadLazily(const std::string& filename, LLVMContext& context, std::string& error)
+{
+    MemoryBuffer* buffer = MemoryBuffer::getFile(filename.c_str(), &error);
+    if (buffer == NULL) return NULL;
+
+    //the module owns the buffer if it could be read
+    Module* module = getLazyBitcodeModule(buffer, context, &error);
+    if (module == NULL)
+    {
+        delete buffer;
+        return NULL;
+    }
+
+    if (!materializeLoopFunctions(*module, error))
+    {
+        delete module;
+        return NULL;
+    }
+
+    return module;
+}
+
+//parse one input and keep the record of every analysed loop
+static void analyzeFile(FileResult& file)
+{
+    LLVMContext context;
+    std::auto_ptr<Module> module;
+    bool isLazy = lazy && sys::Path(file.filename).getSuffix() == "bc";
+
+    if (isLazy)
+    {
+        std::string error;
+        module.reset(loadLazily(file.filename, context, error));
+        if (module.get() == NULL)
+        {
+            file.error = "ielsections: " + file.filename + ": " + error + "\n";
+            return;
+        }
+    }
+    else
+    {
+        SMDiagnostic error;
+        module.reset(ParseIRFile(file.filename, error, context));
+        if (module.get() == NULL)
+        {
+            raw_string_ostream os(file.error);
+            error.Print("ielsections", os);
+            return;
+        }
+    }
+
+    //the pass manager owns the passes, so the records are copied before it goes away
+    PassManager passes;
+    if (!noMem2Reg)
+    {
+        passes.add(createPromoteMemoryToRegisterPass());
+    }
+
+    //with -iel:threads the functions of the module are analysed concurrently
+    SIL* sil = NULL;
+    SILScheduler* scheduler = NULL;
+    if (silThreads != 1)
+    {
+        scheduler = new SILScheduler();
+        passes.add(scheduler);
+    }
+    else
+    {
+        sil = new SIL();
+        passes.add(sil);
+    }
+
+    if (isLazy)
+    {
+        passes.add(new ReleaseBody());
+    }
+
+    std::ostringstream out;
+    std::ostringstream err;
+    redirectOutput(&out, &err);
+    passes.run(*module);
+    redirectOutput(NULL, NULL);
+
+    file.out = out.str();
+    file.err = err.str();
+
+    file.records = scheduler != NULL ? scheduler->getResult().getRecords() : sil->getResult().getRecords();
+    file.isRead = true;
+}
+
+static void* runWorker(void* arg)
+{
+    CorpusWork* work = static_cast<CorpusWork*>(arg);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&work->lock);
+        unsigned int i = work->next++;
+        pthread_mutex_unlock(&work->lock);
+
+        if (i >= work->order.size()) break;
+
+        analyzeFile((*work->files)[work->order[i]]);
+    }
+
+    return NULL;
+}
+
+//return false if filename can not be examined
+static bool getFileStatus(const std::string& filename, uint64_t& size, sys::TimeValue& modified)
+{
+    sys::PathWithStatus path(filename);
+    const sys::FileStatus* status = path.getFileStatus();
+    if (status == NULL) return false;
+
+    size = status->getSize();
+    modified = status->getTimestamp();
+    return true;
+}
+
+static bool isInput(const sys::Path& path)
+{
+    std::string suffix = path.getSuffix();
+    return suffix == "bc" || suffix == "ll";
+}
+
+//add filename, or the .bc and .ll files below it if it is a directory
+static void addInput(const sys::Path& path, std::vector<FileResult>& files)
+{
+    if (path.isDirectory())
+    {
+        std::set<sys::Path> contents;
+        std::string error;
+
+        if (path.getDirectoryContents(contents, &error))
+        {
+            std::cerr << "ielsections: " << error << std::endl;
+            return;
+        }
+
+        for (std::set<sys::Path>::iterator i = contents.begin(); i != contents.end(); ++i)
+        {
+            if (i->isDirectory() || isInput(*i))
+            {
+                addInput(*i, files);
+            }
+        }
+
+        return;
+    }
+
+    FileResult file(path.str(), 0);
+    getFileStatus(file.filename, file.size, file.modified);
+    files.push_back(file);
+}
+
+//orders file indices by decreasing size, so that the largest files do not start last
+class LargerFirst
+{
+    public:
+        LargerFirst(const std::vector<FileResult>& files) : m_files(files) {}
+
+        bool operator()(unsigned int a, unsigned int b) const { return m_files[a].size > m_files[b].size; }
+
+    private:
+        const std::vector<FileResult>& m_files;
+};
+
+static void analyzeFiles(std::vector<FileResult>& files)
+{
+    unsigned int threads = numThreads;
+    if (threads == 0)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? processors : 1;
+    }
+    threads = std::min(threads, (unsigned int)files.size());
+
+    CorpusWork work;
+    work.files = &files;
+    work.next = 0;
+    pthread_mutex_init(&work.lock, NULL);
+
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        work.order.push_back(i);
+    }
+
+    if (threads > 1)
+    {
+        std::stable_sort(work.order.begin(), work.order.end(), LargerFirst(files));
+
+        //a server analyses changed files again and again
+        if (!llvm_is_multithreaded())
+        {
+            llvm_start_multithreaded();
+        }
+    }
+
+    //the calling thread is one of the workers
+    std::vector<pthread_t> workers;
+    for (unsigned int i = 1; i < threads; ++i)
+    {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, runWorker, &work) != 0) break;
+        workers.push_back(worker);
+    }
+
+    runWorker(&work);
+
+    for (std::vector<pthread_t>::iterator i = workers.begin(); i != workers.end(); ++i)
+    {
+        pthread_join(*i, NULL);
+    }
+
+    pthread_mutex_destroy(&work.lock);
+}
+
+//what the analysis of every file printed, in input order
+static void printOutput(const std::vector<FileResult>& files)
+{
+    for (std::vector<FileResult>::const_iterator i = files.begin(); i != files.end(); ++i)
+    {
+        std::cout << i->out;
+        std::cerr << i->err;
+    }
+}
+
+//the records of every file in input order, then the totals of the corpus
+static void printReport(const std::vector<FileResult>& files, std::ostream& os)
+{
+    unsigned int failed = 0;
+    unsigned int loops = 0;
+    unsigned int verdicts[IELSectionRecord::Cold + 1] = {0};
+
+    for (std::vector<FileResult>::const_iterator i = files.begin(); i != files.end(); ++i)
+    {
+        if (!i->isRead)
+        {
+            std::cerr << i->error;
+            ++failed;
+            continue;
+        }
+
+        os << "# " << i->filename << "\n";
+        for (std::vector<IELSectionRecord>::const_iterator j = i->records.begin(); j != i->records.end(); ++j)
+        {
+            j->print(os);
+            ++verdicts[j->verdict];
+        }
+        loops += i->records.size();
+    }
+
+    if (files.size() > 1)
+    {
+        os << "# total files " << files.size() << " failed " << failed << " loops " << loops;
+        for (unsigned int i = 0; i <= IELSectionRecord::Cold; ++i)
+        {
+            os << " " << IELSectionRecord::getVerdictName((IELSectionRecord::Verdict)i) << " " << verdicts[i];
+        }
+        os << "\n";
+    }
+}
+
+//analyse the inputs that were not analysed yet, whose size or modification time
+//changed since they were analysed last, or that disappeared, and rebuild index if
+//there were any. The files are examined on every request, which is cheap next to
+//analysing one
+static void refreshFiles(std::vector<FileResult>& files, SILResult& index)
+{
+    std::vector<FileResult> changed;
+    std::vector<unsigned int> indices;
+
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        uint64_t size = 0;
+        sys::TimeValue modified;
+        bool exists = getFileStatus(files[i].filename, size, modified);
+        bool isNew = !files[i].isRead && files[i].error.empty();
+
+        if (isNew || (exists ? size != files[i].size || modified != files[i].modified : files[i].isRead))
+        {
+            changed.push_back(FileResult(files[i].filename, size));
+            changed.back().modified = modified;
+            indices.push_back(i);
+        }
+    }
+
+    if (changed.empty()) return;
+
+    analyzeFiles(changed);
+    printOutput(changed);
+
+    for (unsigned int i = 0; i < changed.size(); ++i)
+    {
+        std::cerr << changed[i].error;
+        files[indices[i]] = changed[i];
+    }
+
+    index.clear();
+    for (std::vector<FileResult>::iterator i = files.begin(); i != files.end(); ++i)
+    {
+        for (std::vector<IELSectionRecord>::iterator j = i->records.begin(); j != i->records.end(); ++j)
+        {
+            index.add(*j);
+        }
+    }
+}
+
+//answer one request line. A request is one of
+//  loops <function>          the records of the loops of function
+//  summary <function>        one line with the number of loops of function per verdict
+//  at <file>:<line>          the records of the loops of source file that contain line,
+//  at <file>:<first>-<last>  or that overlap the line range
+//  input <filename>          the records of one input of the corpus
+//  shutdown                  stop the server
+//The response is "ok <n>" followed by n lines, the records in the one line format of
+//IELSectionRecord::print, or a single "error <message>" line.
+//Return false if the server should shut down
+static bool answerRequest(const std::string& request, std::vector<FileResult>& files, SILResult& index, std::ostringstream& response)
+{
+    std::istringstream fields(request);
+    std::string command;
+    std::string argument;
+    fields >> command;
+    std::getline(fields >> std::ws, argument);
+
+    if (command == "shutdown")
+    {
+        response << "ok 0\n";
+        return false;
+    }
+
+    refreshFiles(files, index);
+
+    std::vector<const IELSectionRecord*> records;
+
+    if (command == "loops")
+    {
+        index.findByFunction(argument, records);
+    }
+    else if (command == "summary")
+    {
+        index.findByFunction(argument, records);
+
+        unsigned int verdicts[IELSectionRecord::Cold + 1] = {0};
+        for (std::vector<const IELSectionRecord*>::iterator i = records.begin(); i != records.end(); ++i)
+        {
+            ++verdicts[(*i)->verdict];
+        }
+
+        response << "ok 1\n" << argument << " loops " << records.size();
+        for (unsigned int i = 0; i <= IELSectionRecord::Cold; ++i)
+        {
+            response << " " << IELSectionRecord::getVerdictName((IELSectionRecord::Verdict)i) << " " << verdicts[i];
+        }
+        response << "\n";
+        return true;
+    }
+    else if (command == "at")
+    {
+        std::string file;
+        int firstLine, lastLine;
+        if (!ResultDatabase::parseRange(argument, file, firstLine, lastLine))
+        {
+            response << "error expected file:line or file:first-last instead of " << argument << "\n";
+            return true;
+        }
+
+        index.findByLineRange(file, firstLine, lastLine, records);
+    }
+    else if (command == "input")
+    {
+        std::vector<FileResult>::iterator file = files.begin();
+        while (file != files.end() && file->filename != argument) ++file;
+
+        if (file == files.end())
+        {
+            response << "error " << argument << " is not an input\n";
+            return true;
+        }
+
+        if (!file->isRead)
+        {
+            response << "error " << argument << " could not be read\n";
+            return true;
+        }
+
+        for (std::vector<IELSectionRecord>::iterator i = file->records.begin(); i != file->records.end(); ++i)
+        {
+            records.push_back(&*i);
+        }
+    }
+    else
+    {
+        response << "error unknown request " << command << "\n";
+        return true;
+    }
+
+    response << "ok " << records.size() << "\n";
+    for (std::vector<const IELSectionRecord*>::iterator i = records.begin(); i != records.end(); ++i)
+    {
+        (*i)->print(response);
+    }
+
+    return true;
+}
+
+//return false if the client went away
+static bool writeAll(int connection, const std::string& data)
+{
+    const char* next = data.data();
+    size_t left = data.size();
+
+    while (left != 0)
+    {
+        ssize_t written = write(connection, next, left);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+
+        next += written;
+        left -= written;
+    }
+
+    return true;
+}
+
+//answer the requests of one client, one per line, until it closes the connection.
+//Return false if it asked the server to shut down
+static bool serveConnection(int connection, std::vector<FileResult>& files, SILResult& index)
+{
+    std::string pending;
+    char buffer[4096];
+
+    for (;;)
+    {
+        ssize_t count = read(connection, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return true;
+
+        pending.append(buffer, count);
+
+        std::string::size_type end;
+        while ((end = pending.find('\n')) != std::string::npos)
+        {
+            std::string request = pending.substr(0, end);
+            pending.erase(0, end + 1);
+
+            if (!request.empty() && request[request.size() - 1] == '\r')
+            {
+                request.erase(request.size() - 1);
+            }
+            if (request.empty()) continue;
+
+            std::ostringstream response;
+            bool isRunning = answerRequest(request, files, index, response);
+
+            if (!writeAll(connection, response.str())) return isRunning;
+            if (!isRunning) return false;
+        }
+    }
+}
+
+//the clients are served one after another, each request is answered from memory
+//unless an input changed
+static int serve(std::vector<FileResult>& files)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "ielsections: socket name " << socketPath << " is too long" << std::endl;
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        std::cerr << "ielsections: can not create a socket: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    //a socket left behind by an earlier server
+    unlink(socketPath.c_str());
+
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0)
+    {
+        std::cerr << "ielsections: can not listen on " << socketPath << ": " << strerror(errno) << std::endl;
+        close(listener);
+        return 1;
+    }
+
+    //a client that goes away must not take the server with it
+    signal(SIGPIPE, SIG_IGN);
+
+    SILResult index;
+    refreshFiles(files, index);
+
+    bool isRunning = true;
+    while (isRunning)
+    {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+
+            std::cerr << "ielsections: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        isRunning = serveConnection(connection, files, index);
+        close(connection);
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    return isRunning ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    sys::PrintStackTraceOnErrorSignal();
+    PrettyStackTraceProgram stackTrace(argc, argv);
+    llvm_shutdown_obj shutdown;
+
+    cl::ParseCommandLineOptions(argc, argv, "find IE/L sections\n");
+
+    std::ofstream file;
+    if (outputFile != "-")
+    {
+        file.open(outputFile.c_str());
+        if (!file)
+        {
+            std::cerr << "ielsections: can not open " << outputFile << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<FileResult> files;
+    for (unsigned int i = 0; i < inputFiles.size(); ++i)
+    {
+        addInput(sys::Path(inputFiles[i]), files);
+    }
+
+    if (!fileList.empty())
+    {
+        std::ifstream list(fileList.c_str());
+        if (!list)
+        {
+            std::cerr << "ielsections: can not open " << fileList << std::endl;
+            return 1;
+        }
+
+        std::string line;
+        while (std::getline(list, line))
+        {
+            if (!line.empty()) addInput(sys::Path(line), files);
+        }
+    }
+
+    if (files.empty())
+    {
+        std::cerr << "ielsections: no input files" << std::endl;
+        return 1;
+    }
+
+    if (!socketPath.empty())
+    {
+        return serve(files);
+    }
+
+    analyzeFiles(files);
+    printOutput(files);
+
+    std::ostream& os = outputFile != "-" ? file : std::cout;
+    printReport(files, os);
+
+    if (!database.empty())
+    {
+        std::vector<IELSectionRecord> records;
+        for (std::vector<FileResult>::iterator i = files.begin(); i != files.end(); ++i)
+        {
+            records.insert(records.end(), i->records.begin(), i->records.end());
+        }
+
+        std::string error;
+        if (!ResultDatabase::write(database, records, error))
+        {
+            std::cerr << "ielsections: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    for (std::vector<FileResult>::iterator i = files.begin(); i != files.end(); ++i)
+    {
+        if (!i->isRead) return 1;
+    }
+
+    return 0;
+}
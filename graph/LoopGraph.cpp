@@ -1,4 +1,5 @@
 #include "LoopGraph.h"
+#include "../utils.h"
 
 using namespace llvm;
 
@@ -42,11 +43,15 @@ void LoopGraph::generateDotFile(std::string functionName)
         }
     }
 
-    const std::vector<IELSection*>& ielSections = sil.getIELSections();
-    for (std::vector<IELSection*>::const_iterator i = ielSections.begin(); i != ielSections.end(); ++i)
+    const SILResult& result = sil.getResult();
+    const std::vector<Loop*>& loops = sil.getLoops();
+    for (std::vector<Loop*>::const_iterator i = loops.begin(); i != loops.end(); ++i)
     {
-        std::string iel = (*i)->getLoop()->getHeader()->getName().str();
-        m_file << iel + " [style=filled, label=\"" + iel + "\"]\n";
+        if (result.isIELSection(*i))
+        {
+            std::string iel = (*i)->getHeader()->getName().str();
+            m_file << iel + " [style=filled, label=\"" + iel + "\"]\n";
+        }
     }
 
     m_file << "}\n";
@@ -56,12 +61,15 @@ void LoopGraph::constructLoopGraph(Function& function)
 {
     const SIL& sil = getAnalysis<SIL>();
     LoopInfo& loopInfo = getAnalysis<LoopInfo>();
+    const ValueNumbering& numbering = getAnalysis<ValueNumbering>();
     const std::vector<Loop*>& loops = sil.getLoops();
 
+    BitVector visited(numbering.getNumBlocks());
+
     for (std::vector<Loop*>::const_iterator i = loops.begin(); i != loops.end(); ++i)
     {
         Loop* loop = *i;
-        std::map<BasicBlock*, bool> visited;
+        visited.reset();
         std::queue<BasicBlock*> blockQueue;
 
         assert(loop != NULL);
@@ -78,7 +86,7 @@ void LoopGraph::constructLoopGraph(Function& function)
 
             for (succ_iterator succ = succ_begin(block); succ != succ_end(block); ++succ)
             {
-                if (visited.find(*succ) == visited.end())
+                if (!visited.test(numbering.getBlockNumber(*succ)))
                 {
                     Loop* containingLoop = loopInfo.getLoopFor(*succ);
                     if (containingLoop != NULL && containingLoop != loop)
@@ -87,7 +95,7 @@ void LoopGraph::constructLoopGraph(Function& function)
                     }
 
                     blockQueue.push(*succ);
-		    visited[block] = true;
+		    visited.set(numbering.getBlockNumber(*succ));
                 }
             }
         }
@@ -96,8 +104,10 @@ void LoopGraph::constructLoopGraph(Function& function)
 
 bool LoopGraph::runOnFunction(Function& function)
 {
+    //the loops of the previous function are gone with its LoopInfo
+    m_loopGraph.clear();
     constructLoopGraph(function);
-    std::cout << function.getName().str() << std::endl;
+    ielOut() << function.getName().str() << std::endl;
     generateDotFile(function.getName().str());
     return false;
 }
@@ -105,6 +115,7 @@ bool LoopGraph::runOnFunction(Function& function)
 void LoopGraph::getAnalysisUsage(AnalysisUsage& AU) const
 {
     AU.setPreservesAll();
+    AU.addRequired<ValueNumbering>();
     AU.addRequired<LoopInfo>();
     AU.addRequired<SIL>();
 }
@@ -1,6 +1,7 @@
 #include "llvm/BasicBlock.h"
 #include "llvm/Support/InstIterator.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/Type.h"
 #include "../SIL.h"
 #include <iostream>
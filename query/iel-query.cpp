@@ -0,0 +1,68 @@
+//iel-query: look up loops in a result database written with -iel:db or ielsections -db.
+//Every query is either file:line, file:first-last or -function name, and prints the
+//matching records in the one line format of IELSectionRecord::print
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "../ResultDatabase.h"
+#include <iostream>
+
+using namespace llvm;
+
+static cl::opt<std::string> databaseFile(cl::Positional, cl::desc("<database>"), cl::Required);
+static cl::list<std::string> ranges(cl::Positional, cl::desc("<file:line or file:first-last>..."), cl::ZeroOrMore);
+static cl::list<std::string> functions("function", cl::desc("Print the loops of function"), cl::value_desc("name"), cl::ZeroOrMore);
+static cl::opt<bool> acceptedOnly("accepted", cl::desc("Only print the IE/L sections"));
+
+static void printRecords(const ResultDatabase& database, const std::vector<unsigned int>& records)
+{
+    for (std::vector<unsigned int>::const_iterator i = records.begin(); i != records.end(); ++i)
+    {
+        if (!acceptedOnly || database.getRecord(*i).verdict == IELSectionRecord::Accepted)
+        {
+            database.print(*i, std::cout);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    llvm_shutdown_obj shutdown;
+    cl::ParseCommandLineOptions(argc, argv, "query an IE/L result database\n");
+
+    ResultDatabase database;
+    std::string error;
+    if (!database.open(databaseFile, error))
+    {
+        std::cerr << "iel-query: " << error << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+
+    for (unsigned int i = 0; i < ranges.size(); ++i)
+    {
+        std::string file;
+        int firstLine, lastLine;
+
+        if (!ResultDatabase::parseRange(ranges[i], file, firstLine, lastLine))
+        {
+            std::cerr << "iel-query: expected file:line or file:first-last instead of " << ranges[i] << std::endl;
+            status = 1;
+            continue;
+        }
+
+        std::vector<unsigned int> records;
+        database.findByLineRange(file.c_str(), firstLine, lastLine, records);
+        printRecords(database, records);
+    }
+
+    for (unsigned int i = 0; i < functions.size(); ++i)
+    {
+        std::vector<unsigned int> records;
+        database.findByFunction(functions[i].c_str(), records);
+        printRecords(database, records);
+    }
+
+    return status;
+}
@@ -1,12 +1,16 @@
 #include "utils.h"
+#include "llvm/Support/raw_os_ostream.h"
+#include <algorithm>
 #include <iostream>
 
+static __thread std::ostream* t_out = NULL;
+static __thread std::ostream* t_err = NULL;
+
 //pointerOperand would be the operand for either a store inst or a load inst
-std::set<Value*> findCoreOperand(Value* pointerOperand, Value** coreOperand, const Type** coreOperandType)
+void findCoreOperand(Value* pointerOperand, Value** coreOperand, const Type** coreOperandType, SmallVectorImpl<Value*>* indices)
 {
     assert(pointerOperand != NULL && "target of store inst obtained incorrectly");
 
-    std::set<Value*> indices;
     if (isa<GetElementPtrInst>(pointerOperand) || isa<CastInst>(pointerOperand))
     {
         Value* operand = pointerOperand;
@@ -18,9 +22,12 @@ std::set<Value*> findCoreOperand(Value* pointerOperand, Value** coreOperand, con
             more = false;
             if (GetElementPtrInst* getElementPtrInst = dyn_cast<GetElementPtrInst>(operand))
             {
-                for (User::op_iterator index = getElementPtrInst->idx_begin(); index != getElementPtrInst->idx_end(); ++index)
+                for (User::op_iterator index = getElementPtrInst->idx_begin(); indices != NULL && index != getElementPtrInst->idx_end(); ++index)
                 {
-                    indices.insert(*index);
+                    if (std::find(indices->begin(), indices->end(), *index) == indices->end())
+                    {
+                        indices->push_back(*index);
+                    }
                 }
                 
                 more = true;
@@ -91,8 +98,6 @@ std::set<Value*> findCoreOperand(Value* pointerOperand, Value** coreOperand, con
                 assert(false);
         }
     }
-
-    return indices;
 }
 
 std::pair<int, int> getLineNumber(Loop* loop)
@@ -137,20 +142,43 @@ int getLineNumber(Instruction* inst)
     return -1;
 }
 
-const char* getSourceFile(Loop* loop)
+std::string getSourceFile(Loop* loop)
 {
     return getSourceFile(loop->getHeader()->getFirstNonPHI());
 }
 
-const char* getSourceFile(Instruction* inst)
+std::string getSourceFile(Instruction* inst)
 {
     if (MDNode* node = inst->getMetadata("dbg"))
     {
         DILocation loc(node);
-        return loc.getFilename().str().c_str();
+        return loc.getFilename().str();
     }
 
     //assert(false);
 
     return "";
 }
+
+std::ostream& ielOut(void)
+{
+    return t_out != NULL ? *t_out : std::cout;
+}
+
+std::ostream& ielErr(void)
+{
+    return t_err != NULL ? *t_err : std::cerr;
+}
+
+void redirectOutput(std::ostream* out, std::ostream* err)
+{
+    t_out = out;
+    t_err = err;
+}
+
+void dumpValue(const Value* value)
+{
+    raw_os_ostream os(ielErr());
+    value->print(os);
+    os << "\n";
+}
@@ -1,17 +1,32 @@
 #include "llvm/Instruction.h"
 #include "llvm/Analysis/DebugInfo.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/SmallVector.h"
 #include <string>
+#include <ostream>
 
 #ifndef UTILS_H
 #define UTILS_H
 
 using namespace llvm;
 
-std::set<Value*> findCoreOperand(Value* pointerOperand, Value** coreOperand, const Type** coreOperandType=0);
-const char* getSourceFile(Instruction* inst);
-const char* getSourceFile(Loop* loop);
+//indices receives the distinct array indices used on the way to the core operand.
+//Use CoreOperandCache instead of calling this for the same operand repeatedly
+void findCoreOperand(Value* pointerOperand, Value** coreOperand, const Type** coreOperandType=0, SmallVectorImpl<Value*>* indices=0);
+//these decode the dbg metadata on every call, SIL uses a DebugLocIndex instead
+std::string getSourceFile(Instruction* inst);
+std::string getSourceFile(Loop* loop);
 int getLineNumber(Instruction* inst);
 std::pair<int, int> getLineNumber(Loop* loop);
 
+//the streams the analysis prints to. They are std::cout and std::cerr unless the
+//calling thread redirected them, which SILScheduler does to keep the output of
+//concurrently analysed functions apart. NULL restores the default
+std::ostream& ielOut(void);
+std::ostream& ielErr(void);
+void redirectOutput(std::ostream* out, std::ostream* err);
+
+//print value like Value::dump does, but to ielErr
+void dumpValue(const Value* value);
+
 #endif //UTILS_H